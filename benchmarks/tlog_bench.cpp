@@ -0,0 +1,487 @@
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include "Logger.h"
+#if defined __unix__ || defined __APPLE__
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace aricanli::general;
+
+// Microbenchmarks of Formatter, TimestampCache and Logger
+// Every case runs in batches until a batch takes at least --min-time seconds
+// and reports ns/op, heap allocations/op and bytes/sec of the produced text.
+// Usage: tlog_bench [--filter text] [--min-time seconds] [--format json|csv] [--dir path]
+// Example: tlog_bench --filter logger/char --format csv > before.csv
+
+// operator delete below frees what the counting operator new got from malloc
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Count every heap allocation of the process
+static std::atomic<size_t> g_allocations{ 0 };
+
+// Results of the operations end here, so they are not optimized away
+static volatile size_t g_sink = 0;
+
+void* operator new(std::size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+// Result of one case
+struct BenchResult {
+	std::string name;
+	size_t iterations;
+	double nsPerOp;
+	double allocsPerOp;
+	double bytesPerSec;
+};
+
+// Type with only an operator<<, written through the stream fallback
+struct Point {
+	int x, y;
+};
+
+template <typename T>
+std::basic_ostream<T>& operator<<(std::basic_ostream<T>& os, const Point& p) {
+	return os << p.x << ',' << p.y;
+}
+
+// Class BenchRunner
+// Select, run and report the cases
+class BenchRunner {
+public:
+	std::string filter;
+	double minTime = 0.2;
+
+	bool selected(const std::string& t_name) const {
+		return filter.empty() || t_name.find(filter) != std::string::npos;
+	}
+
+	/*
+	* Run a case
+	* @param t_name: group/type/case
+	* @param op: one operation, returns the bytes it produced
+	* @param t_batchBytes: optional, returns the bytes written so far, used instead of the sum of op()
+	*/
+	template <typename F>
+	void run(const std::string& t_name, F&& op, std::function<unsigned long long()> t_batchBytes = nullptr) {
+
+		if (!selected(t_name))
+			return;
+
+		size_t sink = 0;
+		for (int i = 0; i < 1000; i++)
+			sink += op();
+
+		size_t iterations = 1000;
+		for (;;) {
+			unsigned long long bytesBefore = t_batchBytes ? t_batchBytes() : 0;
+			size_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+			auto start = std::chrono::steady_clock::now();
+
+			size_t bytes = 0;
+			for (size_t i = 0; i < iterations; i++)
+				bytes += op();
+			if (m_afterBatch)
+				m_afterBatch();
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			size_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+			if (t_batchBytes)
+				bytes = static_cast<size_t>(t_batchBytes() - bytesBefore);
+			sink += bytes;
+
+			if (elapsed.count() >= minTime || iterations >= (size_t(1) << 32)) {
+				double seconds = elapsed.count();
+				m_results.push_back({ t_name, iterations, seconds * 1e9 / iterations,
+					static_cast<double>(allocations) / iterations, seconds > 0 ? bytes / seconds : 0 });
+				std::cerr << t_name << " : " << m_results.back().nsPerOp << " ns/op\n";
+				break;
+			}
+
+			// aim at 1.5 times the minimum time, grow at most ten times per batch
+			double scale = elapsed.count() > 0 ? minTime * 1.5 / elapsed.count() : 10.0;
+			if (scale > 10.0)
+				scale = 10.0;
+			if (scale < 2.0)
+				scale = 2.0;
+			iterations = static_cast<size_t>(iterations * scale);
+		}
+		g_sink = g_sink + sink;
+	}
+
+	/*
+	* Called at the end of every timed batch, flush() of the logger cases
+	*/
+	void afterBatch(std::function<void()> t_afterBatch) {
+		m_afterBatch = std::move(t_afterBatch);
+	}
+
+	void writeJson(std::ostream& out) const {
+		out << "{\n  \"context\": {\"min_time\": " << minTime << "},\n  \"benchmarks\": [\n";
+		for (size_t i = 0; i < m_results.size(); i++) {
+			const BenchResult& r = m_results[i];
+			out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+				<< ", \"ns_per_op\": " << r.nsPerOp << ", \"allocs_per_op\": " << r.allocsPerOp
+				<< ", \"bytes_per_sec\": " << r.bytesPerSec << "}" << (i + 1 < m_results.size() ? ",\n" : "\n");
+		}
+		out << "  ]\n}\n";
+	}
+
+	void writeCsv(std::ostream& out) const {
+		out << "name,iterations,ns_per_op,allocs_per_op,bytes_per_sec\n";
+		for (const auto& r : m_results)
+			out << r.name << ',' << r.iterations << ',' << r.nsPerOp << ',' << r.allocsPerOp << ',' << r.bytesPerSec << '\n';
+	}
+
+protected:
+	std::vector<BenchResult> m_results;
+	std::function<void()> m_afterBatch;
+}; // end of class
+
+// Send fd 1 to the null device while the console cases run, the report is written afterwards
+class StdoutToNull {
+public:
+	StdoutToNull() {
+		std::cout.flush();
+		std::wcout.flush();
+#if defined __unix__ || defined __APPLE__
+		m_saved = dup(1);
+		int null = ::open("/dev/null", O_WRONLY);
+		if (null >= 0) {
+			dup2(null, 1);
+			::close(null);
+		}
+#endif
+	}
+
+	~StdoutToNull() {
+		std::cout.flush();
+		std::wcout.flush();
+#if defined __unix__ || defined __APPLE__
+		if (m_saved >= 0) {
+			dup2(m_saved, 1);
+			::close(m_saved);
+		}
+#endif
+	}
+
+protected:
+	int m_saved = -1;
+};
+
+template <typename T>
+std::string typeName() {
+	return sizeof(T) == 1 ? "char" : "wchar_t";
+}
+
+// Formatter::format() with one argument of each type, the pattern is only %m
+template <typename T>
+void formatArgs(BenchRunner& bench) {
+	using String = std::basic_string<T>;
+	const std::string group = "format/" + typeName<T>() + "/arg/";
+	Formatter<T>::getFormatter(stringlit(T, "%m"));
+
+	String owned = stringlit(T, "Sed ornare commodo urna, eget sollicitudin ex eleifend ut.");
+	const T* pointer = owned.c_str();
+	std::string narrow = "Sed ornare commodo urna, eget sollicitudin ex eleifend ut.";
+	std::wstring wide = L"Sed ornare commodo urna, eget sollicitudin ex eleifend ut.";
+	Point point{ 12, -7 };
+
+	bench.run(group + "int", [&] { return Formatter<T>::format(123456789).size() * sizeof(T); });
+	bench.run(group + "uint64", [&] { return Formatter<T>::format(18446744073709551615ULL).size() * sizeof(T); });
+	bench.run(group + "double", [&] { return Formatter<T>::format(3.14159).size() * sizeof(T); });
+	bench.run(group + "float", [&] { return Formatter<T>::format(2.712f).size() * sizeof(T); });
+	bench.run(group + "bool", [&] { return Formatter<T>::format(true).size() * sizeof(T); });
+	bench.run(group + "char", [&] { return Formatter<T>::format(static_cast<T>('A')).size() * sizeof(T); });
+	bench.run(group + "literal", [&] { return Formatter<T>::format(stringlit(T, "Lorem ipsum dolor sit amet, consectetur adipiscing elit.")).size() * sizeof(T); });
+	bench.run(group + "pointer", [&] { return Formatter<T>::format(pointer).size() * sizeof(T); });
+	bench.run(group + "string", [&] { return Formatter<T>::format(owned).size() * sizeof(T); });
+	bench.run(group + "narrow-string", [&] { return Formatter<T>::format(narrow).size() * sizeof(T); });
+	bench.run(group + "wide-string", [&] { return Formatter<T>::format(wide).size() * sizeof(T); });
+	bench.run(group + "operator<<", [&] { return Formatter<T>::format(point).size() * sizeof(T); });
+	bench.run(group + "field", [&] { return Formatter<T>::format(field("attempt", 3)).size() * sizeof(T); });
+	bench.run(group + "mixed", [&] {
+		return Formatter<T>::format(stringlit(T, "tellus felis condimentum odio, : "), 1, static_cast<T>('A'), 3.14159, owned).size() * sizeof(T);
+	});
+}
+
+// Formatter::formatRecord() with one field of the pattern, the message is already formatted
+template <typename T>
+void formatPatterns(BenchRunner& bench) {
+	using String = std::basic_string<T>;
+	const std::string group = "format/" + typeName<T>() + "/pattern/";
+	String message = stringlit(T, "ERROR: Lorem ipsum dolor sit amet, consectetur adipiscing elit. ");
+	const char* file = "examples/BasicBenchmarkTestIInChar.cpp";
+
+	struct PatternCase {
+		const char* name;
+		String pattern;
+		formatPattern layout;
+	};
+	std::vector<PatternCase> cases = {
+		{ "%m", stringlit(T, "%m"), formatPattern::TEXT },
+		{ "%t", stringlit(T, "%t"), formatPattern::TEXT },
+		{ "%l", stringlit(T, "%l"), formatPattern::TEXT },
+		{ "%f", stringlit(T, "%f"), formatPattern::TEXT },
+		{ "literal", stringlit(T, "[message]"), formatPattern::TEXT },
+		{ "%t %l %f %m", stringlit(T, "%t %l %f %m"), formatPattern::TEXT },
+		{ "json", stringlit(T, "%t %l %f %m"), formatPattern::JSON },
+		{ "logfmt", stringlit(T, "%t %l %f %m"), formatPattern::LOGFMT },
+	};
+
+	String out;
+	std::vector<FieldSpan> noFields;
+	for (const auto& c : cases) {
+		Formatter<T>::getFormatter(c.pattern, c.layout);
+		FormatPattern<T> pattern = Formatter<T>::compilePattern(c.pattern, c.layout);
+		bench.run(group + c.name, [&] {
+			out.clear();
+			auto now = std::chrono::system_clock::now();
+			if (c.layout == formatPattern::TEXT)
+				Formatter<T>::appendRecord(out, pattern, message, now, 128, file);
+			else
+				Formatter<T>::appendStructured(out, pattern, "error", message.data() + 7, message.size() - 7, noFields, now, 128, file);
+			return out.size() * sizeof(T);
+		});
+	}
+	Formatter<T>::getFormatter(stringlit(T, "%m %t"));
+}
+
+// TimestampCache, the seconds are rebuilt once a second or on every call
+template <typename T>
+void timestamps(BenchRunner& bench) {
+	const std::string group = "timestamp/" + typeName<T>() + "/";
+	TimestampCache<T> cache;
+	size_t length;
+
+	bench.run(group + "ms", [&] {
+		cache.get(std::chrono::system_clock::now(), TimePrecision::Milliseconds, TimeZone::Local, length);
+		return length * sizeof(T);
+	});
+	bench.run(group + "ns", [&] {
+		cache.get(std::chrono::system_clock::now(), TimePrecision::Nanoseconds, TimeZone::Local, length);
+		return length * sizeof(T);
+	});
+	bench.run(group + "utc", [&] {
+		cache.get(std::chrono::system_clock::now(), TimePrecision::Milliseconds, TimeZone::Utc, length);
+		return length * sizeof(T);
+	});
+	auto tp = std::chrono::system_clock::now();
+	bench.run(group + "new-second", [&] {
+		tp += std::chrono::seconds(1);
+		cache.get(tp, TimePrecision::Milliseconds, TimeZone::Local, length);
+		return length * sizeof(T);
+	});
+}
+
+// Text of a record of the logger cases, for the bytes of the console and text file sinks
+template <typename T, typename ...Args>
+size_t lineBytes(Args &&...args) {
+	std::basic_string<T> message = stringlit(T, "ERROR: ");
+	Formatter<T>::appendMessage(message, std::forward<Args>(args)...);
+	std::basic_string<T> line = Formatter<T>::formatRecord(message, std::chrono::system_clock::now());
+	std::string utf8;
+	appendUtf8(utf8, line.data(), line.size());
+	return utf8.size() + 1;
+}
+
+template <typename T>
+std::basic_string<T> widen(const std::string& t_text) {
+	return std::basic_string<T>(t_text.begin(), t_text.end());
+}
+
+// Logger<T>::log() with disabled levels and with each sink
+template <typename T>
+void logger(BenchRunner& bench, const std::string& t_dir) {
+	using String = std::basic_string<T>;
+	const std::string filtered = "filtered/" + typeName<T>() + "/";
+	const std::string group = "logger/" + typeName<T>() + "/";
+	String owned = stringlit(T, "Vestibulum at maximus ante.");
+
+	Logger<T>::getInstance();
+	Logger<T>::setFormatter(stringlit(T, "%t %m"));
+	auto logLine = [&] {
+		Logger<T>::log(LogPriority::Error, stringlit(T, "tellus felis condimentum odio, : "), 1, static_cast<T>('A'), 3.14159, owned);
+	};
+	size_t bytes = lineBytes<T>(stringlit(T, "tellus felis condimentum odio, : "), 1, static_cast<T>('A'), 3.14159, owned);
+
+	// calls below the level, the arguments are not evaluated by the macros
+	Logger<T>::setLogPriority(LogPriority::Info);
+	bench.run(filtered + "log", [&] {
+		Logger<T>::log(LogPriority::Debug, stringlit(T, "tellus felis condimentum odio, : "), 1, owned);
+		return size_t(0);
+	});
+	bench.run(filtered + "macro", [&] {
+		TLOG_LOG_IF_ENABLED(T, LogPriority::Debug, stringlit(T, "tellus felis condimentum odio, : "), 1, owned);
+		return size_t(0);
+	});
+	// below the level but captured into the ring of setBacktrace()
+	if (bench.selected(filtered + "backtrace")) {
+		Logger<T>::setBacktrace(1024, LogPriority::Quiet);
+		bench.run(filtered + "backtrace", [&] {
+			TLOG_LOG_IF_ENABLED(T, LogPriority::Debug, stringlit(T, "tellus felis condimentum odio, : "), 1, owned);
+			return size_t(0);
+		});
+		Logger<T>::setBacktrace(0);
+	}
+	Logger<T>::setLogPriority(LogPriority::Trace);
+
+	// enabled calls rejected by the state of the call site, only the first one is written
+	if (bench.selected(filtered + "rate-limited") || bench.selected(filtered + "sampled")) {
+		StdoutToNull redirect;
+		bench.run(filtered + "rate-limited", [&] {
+			TLOG_LOGGER_LIMITED(Logger<T>::defaultLogger(), LogPriority::Error, 1, stringlit(T, "tellus felis condimentum odio, : "), 1, owned);
+			return size_t(0);
+		});
+		bench.run(filtered + "sampled", [&] {
+			TLOG_LOGGER_SAMPLED(Logger<T>::defaultLogger(), LogPriority::Error, 1000000000, stringlit(T, "tellus felis condimentum odio, : "), 1, owned);
+			return size_t(0);
+		});
+	}
+
+	bench.afterBatch([] { Logger<T>::flush(); });
+
+	if (bench.selected(group + "console")) {
+		StdoutToNull redirect;
+		Logger<T>::setSinks({ std::make_shared<ConsoleSink<T>>() });
+		bench.run(group + "console", [&] { logLine(); return bytes; });
+	}
+
+	if (bench.selected(group + "stdio")) {
+		StdoutToNull redirect;
+		Logger<T>::setSinks({ std::make_shared<StdioSink<T>>() });
+		bench.run(group + "stdio", [&] { logLine(); return bytes; });
+		Logger<T>::setSinks({});
+	}
+
+	struct FileCase {
+		const char* name;
+		FileBackend backend;
+		FileFormat format;
+		bool async;
+		bool deferred;
+		bool metrics;
+	};
+	const FileCase cases[] = {
+		{ "file-stream", FileBackend::Stream, FileFormat::Text, false, false, false },
+		{ "file-posix", FileBackend::Posix, FileFormat::Text, false, false, false },
+		{ "file-mapped", FileBackend::Mapped, FileFormat::Text, false, false, false },
+		{ "file-binary", FileBackend::Posix, FileFormat::Binary, false, false, false },
+		{ "file-posix-async", FileBackend::Posix, FileFormat::Text, true, false, false },
+		{ "file-posix-deferred", FileBackend::Posix, FileFormat::Text, true, true, false },
+		{ "file-posix-metrics", FileBackend::Posix, FileFormat::Text, false, false, true },
+	};
+	for (const auto& c : cases) {
+		if (!bench.selected(group + c.name))
+			continue;
+		std::string path = t_dir + "/" + typeName<T>() + "-" + c.name + ".log";
+		auto sink = std::make_shared<FileSink<T>>();
+		sink->setFileLimit(~0ULL);
+		sink->setFileBackend(c.backend);
+		sink->setFileFormat(c.format);
+		sink->open(widen<T>(path));
+		Logger<T>::setSinks({ sink });
+		Logger<T>::setAsyncMode(c.async);
+		Logger<T>::setDeferredFormat(c.deferred);
+		Logger<T>::setMetricsEnabled(c.metrics);
+
+		// binary records have no text to count, the size of the file is read instead
+		std::function<unsigned long long()> fileBytes;
+		if (c.format == FileFormat::Binary) {
+			fileBytes = [path] {
+				std::error_code ec;
+				auto size = std::filesystem::file_size(path, ec);
+				return ec ? 0ULL : static_cast<unsigned long long>(size);
+			};
+		}
+		bench.run(group + c.name, [&] { logLine(); return bytes; }, fileBytes);
+
+		Logger<T>::setAsyncMode(false);
+		Logger<T>::setDeferredFormat(false);
+		Logger<T>::setMetricsEnabled(false);
+		sink->close();
+	}
+	Logger<T>::setSinks({});
+	bench.afterBatch(nullptr);
+}
+
+static void usage() {
+	std::cerr << "Usage: tlog_bench [--filter text] [--min-time seconds] [--format json|csv] [--dir path]\n"
+		<< "  --filter    run the cases whose name contains text\n"
+		<< "  --min-time  minimum seconds of the measured batch, default 0.2\n"
+		<< "  --format    report written to stdout, default json\n"
+		<< "  --dir       directory of the log files, removed at the end, default tlog_bench_files\n";
+}
+
+int main(int argc, char* argv[]) {
+
+	BenchRunner bench;
+	std::string format = "json";
+	std::string dir = "tlog_bench_files";
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc)
+			bench.filter = argv[++i];
+		else if (arg == "--min-time" && i + 1 < argc)
+			bench.minTime = std::atof(argv[++i]);
+		else if (arg == "--format" && i + 1 < argc)
+			format = argv[++i];
+		else if (arg == "--dir" && i + 1 < argc)
+			dir = argv[++i];
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (format != "json" && format != "csv") {
+		usage();
+		return 2;
+	}
+
+	// wide and narrow console output on the same stdout
+	std::ios::sync_with_stdio(false);
+	std::filesystem::create_directories(dir);
+
+	formatArgs<char>(bench);
+	formatArgs<wchar_t>(bench);
+	formatPatterns<char>(bench);
+	formatPatterns<wchar_t>(bench);
+	timestamps<char>(bench);
+	timestamps<wchar_t>(bench);
+	logger<char>(bench, dir);
+	logger<wchar_t>(bench, dir);
+
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+
+	if (format == "json")
+		bench.writeJson(std::cout);
+	else
+		bench.writeCsv(std::cout);
+	return 0;
+}
@@ -0,0 +1,363 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include "Logger.h"
+#if defined __unix__ || defined __APPLE__
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace aricanli::general;
+
+// Scalability and tail latency of Logger<char>::log() from several threads
+// Thread counts go from 1 up to the number of cores in powers of two, message sizes
+// from a few bytes to several KB. Every call is timed on its own thread and
+// recorded into a histogram, the report has p50, p99, p99.9, max and the throughput
+// of each backend, thread count and message size.
+// Usage: tlog_scale [--threads n] [--messages n] [--sizes 16,256,4096] [--filter text] [--format json|csv] [--dir path]
+// Example: tlog_scale --filter posix --format csv > scale.csv
+
+// Class LatencyHistogram
+// Log-linear buckets like HdrHistogram: values below 2^precision are exact,
+// above that every power of two is split into 2^(precision - 1) buckets,
+// so a recorded value is off by less than 1 / 2^(precision - 1).
+class LatencyHistogram {
+public:
+	static const unsigned precision = 7;
+	static const uint64_t subBuckets = uint64_t(1) << precision;
+	static const uint64_t halfBuckets = subBuckets / 2;
+
+	LatencyHistogram() : m_counts(static_cast<size_t>((66 - precision) * halfBuckets), 0) { }
+
+	void record(uint64_t t_value) noexcept {
+		m_counts[indexOf(t_value)]++;
+		m_total++;
+		if (t_value > m_max)
+			m_max = t_value;
+	}
+
+	void merge(const LatencyHistogram& t_other) {
+		for (size_t i = 0; i < m_counts.size(); i++)
+			m_counts[i] += t_other.m_counts[i];
+		m_total += t_other.m_total;
+		if (t_other.m_max > m_max)
+			m_max = t_other.m_max;
+	}
+
+	/*
+	* Value below which the given fraction of the recorded values are
+	* @param t_quantile: 0.5 for the median, 0.999 for p99.9
+	* @return: highest value of the bucket, exact for the maximum
+	*/
+	uint64_t percentile(double t_quantile) const noexcept {
+		if (m_total == 0)
+			return 0;
+		uint64_t rank = static_cast<uint64_t>(std::ceil(t_quantile * m_total));
+		if (rank == 0)
+			rank = 1;
+		uint64_t seen = 0;
+		for (size_t i = 0; i < m_counts.size(); i++) {
+			seen += m_counts[i];
+			if (seen >= rank) {
+				uint64_t upper = highestOf(i);
+				return upper < m_max ? upper : m_max;
+			}
+		}
+		return m_max;
+	}
+
+	uint64_t max() const noexcept {
+		return m_max;
+	}
+
+	uint64_t count() const noexcept {
+		return m_total;
+	}
+
+protected:
+	static size_t indexOf(uint64_t t_value) noexcept {
+		if (t_value < subBuckets)
+			return static_cast<size_t>(t_value);
+		// t_value >> shift is in [halfBuckets, subBuckets)
+		unsigned magnitude = 63 - countLeadingZeros(t_value);
+		unsigned shift = magnitude - precision + 1;
+		return static_cast<size_t>(shift * halfBuckets + (t_value >> shift));
+	}
+
+	static uint64_t highestOf(size_t t_index) noexcept {
+		if (t_index < subBuckets)
+			return t_index;
+		uint64_t shift = t_index / halfBuckets - 1;
+		uint64_t sub = t_index - shift * halfBuckets;
+		return ((sub + 1) << shift) - 1;
+	}
+
+	static unsigned countLeadingZeros(uint64_t t_value) noexcept {
+#if defined __GNUC__
+		return static_cast<unsigned>(__builtin_clzll(t_value));
+#else
+		unsigned count = 0;
+		for (uint64_t bit = uint64_t(1) << 63; (t_value & bit) == 0; bit >>= 1)
+			count++;
+		return count;
+#endif
+	}
+
+protected:
+	std::vector<uint64_t> m_counts;
+	uint64_t m_total = 0;
+	uint64_t m_max = 0;
+}; // end of class
+
+// Result of one backend, thread count and message size
+struct ScaleResult {
+	std::string backend;
+	unsigned threads;
+	size_t size;
+	uint64_t messages;
+	double seconds;
+	uint64_t p50, p99, p999, max;
+};
+
+// Backend under test, the configuration of the logger for one row of the report
+struct Backend {
+	const char* name;
+	bool console;
+	FileBackend file;
+	FileFormat format;
+	bool async;
+	bool deferred;
+};
+
+// Send fd 1 to the null device while the console backend runs
+class StdoutToNull {
+public:
+	StdoutToNull() {
+		std::cout.flush();
+#if defined __unix__ || defined __APPLE__
+		m_saved = dup(1);
+		int null = ::open("/dev/null", O_WRONLY);
+		if (null >= 0) {
+			dup2(null, 1);
+			::close(null);
+		}
+#endif
+	}
+
+	~StdoutToNull() {
+		std::cout.flush();
+#if defined __unix__ || defined __APPLE__
+		if (m_saved >= 0) {
+			dup2(m_saved, 1);
+			::close(m_saved);
+		}
+#endif
+	}
+
+protected:
+	int m_saved = -1;
+};
+
+/*
+* Log from t_threads threads at once and time every call
+* the threads start together and the time ends when the records are written
+*/
+static ScaleResult runPoint(const Backend& t_backend, unsigned t_threads, size_t t_size, uint64_t t_messages) {
+
+	std::vector<LatencyHistogram> histograms(t_threads);
+	std::vector<std::thread> threads;
+	std::atomic<unsigned> ready{ 0 };
+	std::atomic<bool> go{ false };
+
+	for (unsigned t = 0; t < t_threads; t++) {
+		threads.emplace_back([&, t] {
+			std::string payload(t_size, static_cast<char>('a' + t % 26));
+			LatencyHistogram& histogram = histograms[t];
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire))
+				std::this_thread::yield();
+
+			for (uint64_t i = 0; i < t_messages; i++) {
+				auto start = std::chrono::steady_clock::now();
+				Logger<char>::log(LogPriority::Info, "worker", t, "message", i, payload);
+				auto finish = std::chrono::steady_clock::now();
+				histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count()));
+			}
+		});
+	}
+
+	while (ready.load() != t_threads)
+		std::this_thread::yield();
+	auto start = std::chrono::steady_clock::now();
+	go.store(true, std::memory_order_release);
+	for (auto& thread : threads)
+		thread.join();
+	Logger<char>::flush();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	LatencyHistogram total;
+	for (const auto& histogram : histograms)
+		total.merge(histogram);
+	return { t_backend.name, t_threads, t_size, total.count(), elapsed.count(),
+		total.percentile(0.5), total.percentile(0.99), total.percentile(0.999), total.max() };
+}
+
+static std::vector<size_t> parseSizes(const std::string& t_text) {
+	std::vector<size_t> sizes;
+	size_t begin = 0;
+	while (begin < t_text.size()) {
+		size_t end = t_text.find(',', begin);
+		if (end == std::string::npos)
+			end = t_text.size();
+		sizes.push_back(static_cast<size_t>(std::strtoull(t_text.substr(begin, end - begin).c_str(), nullptr, 10)));
+		begin = end + 1;
+	}
+	return sizes;
+}
+
+static void usage() {
+	std::cerr << "Usage: tlog_scale [--threads n] [--messages n] [--sizes list] [--filter text] [--format json|csv] [--dir path]\n"
+		<< "  --threads   highest thread count, default the number of cores\n"
+		<< "  --messages  calls per thread, fewer for large messages, default 20000\n"
+		<< "  --sizes     payload bytes, default 16,128,1024,4096\n"
+		<< "  --filter    run the backends whose name contains text\n"
+		<< "  --format    report written to stdout, default json\n"
+		<< "  --dir       directory of the log files, removed at the end, default tlog_scale_files\n";
+}
+
+int main(int argc, char* argv[]) {
+
+	unsigned maxThreads = std::thread::hardware_concurrency();
+	uint64_t messages = 20000;
+	std::vector<size_t> sizes = { 16, 128, 1024, 4096 };
+	std::string filter;
+	std::string format = "json";
+	std::string dir = "tlog_scale_files";
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc)
+			maxThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+		else if (arg == "--messages" && i + 1 < argc)
+			messages = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--sizes" && i + 1 < argc)
+			sizes = parseSizes(argv[++i]);
+		else if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--format" && i + 1 < argc)
+			format = argv[++i];
+		else if (arg == "--dir" && i + 1 < argc)
+			dir = argv[++i];
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (maxThreads == 0)
+		maxThreads = 1;
+	if (format != "json" && format != "csv") {
+		usage();
+		return 2;
+	}
+
+	std::vector<unsigned> threadCounts;
+	for (unsigned n = 1; n < maxThreads; n *= 2)
+		threadCounts.push_back(n);
+	threadCounts.push_back(maxThreads);
+
+	const Backend backends[] = {
+		{ "console", true, FileBackend::Stream, FileFormat::Text, false, false },
+		{ "file-stream", false, FileBackend::Stream, FileFormat::Text, false, false },
+		{ "file-posix", false, FileBackend::Posix, FileFormat::Text, false, false },
+		{ "file-mapped", false, FileBackend::Mapped, FileFormat::Text, false, false },
+		{ "file-binary", false, FileBackend::Posix, FileFormat::Binary, false, false },
+		{ "async-posix", false, FileBackend::Posix, FileFormat::Text, true, false },
+		{ "async-deferred-posix", false, FileBackend::Posix, FileFormat::Text, true, true },
+	};
+
+	std::filesystem::create_directories(dir);
+	Logger<char>::getInstance();
+	Logger<char>::setFormatter("%t %m");
+
+	std::vector<ScaleResult> results;
+	for (const auto& backend : backends) {
+		if (!filter.empty() && std::string(backend.name).find(filter) == std::string::npos)
+			continue;
+
+		std::shared_ptr<Sink<char>> sink;
+		std::shared_ptr<FileSink<char>> file;
+		if (backend.console) {
+			sink = std::make_shared<ConsoleSink<char>>();
+		}
+		else {
+			file = std::make_shared<FileSink<char>>();
+			file->setFileLimit(~0ULL);
+			file->setFileBackend(backend.file);
+			file->setFileFormat(backend.format);
+			sink = file;
+		}
+		Logger<char>::setSinks({ sink });
+		Logger<char>::setAsyncMode(backend.async);
+		Logger<char>::setDeferredFormat(backend.deferred);
+
+		for (size_t size : sizes) {
+			for (unsigned threads : threadCounts) {
+				// at most 64 MB of payload per point
+				uint64_t count = messages;
+				uint64_t budget = (64ULL << 20) / ((size + 64) * threads);
+				if (count > budget)
+					count = budget > 100 ? budget : 100;
+
+				if (file)
+					file->open(dir + "/" + backend.name + ".log");
+				{
+					std::unique_ptr<StdoutToNull> redirect(backend.console ? new StdoutToNull : nullptr);
+					results.push_back(runPoint(backend, threads, size, count));
+				}
+				if (file) {
+					file->close();
+					std::error_code ec;
+					std::filesystem::remove(dir + "/" + backend.name + ".log", ec);
+				}
+
+				const ScaleResult& r = results.back();
+				std::cerr << r.backend << " threads=" << r.threads << " size=" << r.size << " : p50 " << r.p50
+					<< " ns, p99 " << r.p99 << " ns, p99.9 " << r.p999 << " ns, max " << r.max << " ns, "
+					<< static_cast<uint64_t>(r.messages / r.seconds) << " msg/s\n";
+			}
+		}
+		Logger<char>::setAsyncMode(false);
+		Logger<char>::setDeferredFormat(false);
+	}
+	Logger<char>::setSinks({});
+
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+
+	if (format == "json") {
+		std::cout << "{\n  \"context\": {\"cores\": " << std::thread::hardware_concurrency() << "},\n  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			const ScaleResult& r = results[i];
+			std::cout << "    {\"backend\": \"" << r.backend << "\", \"threads\": " << r.threads << ", \"size\": " << r.size
+				<< ", \"messages\": " << r.messages << ", \"msgs_per_sec\": " << r.messages / r.seconds
+				<< ", \"bytes_per_sec\": " << r.messages * r.size / r.seconds
+				<< ", \"p50_ns\": " << r.p50 << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999
+				<< ", \"max_ns\": " << r.max << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		std::cout << "  ]\n}\n";
+	}
+	else {
+		std::cout << "backend,threads,size,messages,msgs_per_sec,bytes_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n";
+		for (const auto& r : results)
+			std::cout << r.backend << ',' << r.threads << ',' << r.size << ',' << r.messages << ',' << r.messages / r.seconds << ','
+				<< r.messages * r.size / r.seconds << ',' << r.p50 << ',' << r.p99 << ',' << r.p999 << ',' << r.max << '\n';
+	}
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "Logger.h"
+
+using namespace aricanli::general;
+
+// operator delete below frees what the counting operator new got from malloc
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Count every heap allocation of the process
+static std::atomic<size_t> g_allocations{ 0 };
+
+void* operator new(std::size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+const size_t count = 100'000;
+
+template <typename T>
+void logLoop(const std::basic_string<T>& owned) {
+	for (size_t i = 0; i < count; i++) {
+		Logger<T>::log(LogPriority::Error, __LINE__, __FILE__, stringlit(T, "tellus felis condimentum odio, : "), i, 'A', 3.14159, owned);
+		Logger<T>::log(LogPriority::Info, stringlit(T, "Nunc a varius purus. : "), 2.712, static_cast<T>('z'), -42);
+	}
+}
+
+// Log after a warm up and return heap allocations per log() call
+template <typename T>
+double allocationsPerCall(const std::basic_string<T>& owned) {
+	logLoop(owned);
+	Logger<T>::flush();
+
+	size_t before = g_allocations.load();
+	logLoop(owned);
+	Logger<T>::flush();
+	size_t after = g_allocations.load();
+	return static_cast<double>(after - before) / (2 * count);
+}
+
+int main() {
+
+	Logger<char>::setLogOutput("log/alloc.txt");
+	Logger<char>::setFormatter("%t %l %f %m");
+	auto log = Logger<char>::getInstance();
+	LoggerW::setLogOutput(L"log/allocw.txt");
+	LoggerW::setFormatter(L"%t %m");
+	auto logw = LoggerW::getInstance();
+
+	bool failed = false;
+	auto report = [&](const char* name, double perCall) {
+		std::cout << name << " : " << perCall << " allocations per call\n";
+		failed = failed || perCall != 0;
+	};
+
+	report("char sync", allocationsPerCall(std::string("owned")));
+	report("wchar_t sync", allocationsPerCall(std::wstring(L"owned")));
+
+	Logger<char>::setFileBackend(FileBackend::Posix);
+	report("char sync posix", allocationsPerCall(std::string("owned")));
+
+	Logger<char>::setAsyncMode(true);
+	report("char async", allocationsPerCall(std::string("owned")));
+	Logger<char>::setDeferredFormat(true);
+	report("char async deferred", allocationsPerCall(std::string("owned")));
+	Logger<char>::setAsyncMode(false);
+
+	LoggerW::setAsyncMode(true);
+	LoggerW::setDeferredFormat(true);
+	report("wchar_t async deferred", allocationsPerCall(std::wstring(L"owned")));
+	LoggerW::setAsyncMode(false);
+
+	return failed ? 1 : 0;
+}
@@ -3,14 +3,8 @@
 
 using namespace aricanli::general;
 
-int main() {
-
-	Logger<char>::setLogOutput("basicLog/log/log.txt");
-	Logger<char>::setLogPriority(LogPriority::Debug);
-	auto log = Logger<char>::getInstance();
-	log->setFileLimit(10*1024*1024);
-	log->setFormatter("%t %m");
-	log->log(LogPriority::Quiet);
+// Time 100.000 calls of each level with the selected file backend
+void benchmark(std::shared_ptr<Logger<char>> log) {
 
 	auto start1 = std::chrono::high_resolution_clock::now();
 	for (int i = 0; i < 100'000; i++)
@@ -66,6 +60,28 @@ int main() {
 			<< "\nError : " << elapsed3.count() << "\nWarning" << elapsed4.count()
 			<< "\nInfo : " << elapsed5.count() << "\nVerbose" << elapsed6.count()
 			<< "\nDebug : " << elapsed7.count() << "\nTrace" << elapsed8.count();
+	std::cout << "\n";
+}
+
+int main() {
+
+	Logger<char>::setLogOutput("basicLog/log/log.txt");
+	Logger<char>::setLogPriority(LogPriority::Debug);
+	auto log = Logger<char>::getInstance();
+	log->setFileLimit(10*1024*1024);
+	log->setFormatter("%t %m");
+	log->log(LogPriority::Quiet);
+
+	std::cout << "std::basic_ofstream :\n";
+	benchmark(log);
+
+	Logger<char>::setFileBackend(FileBackend::Posix);
+	std::cout << "\nPosix file descriptor :\n";
+	benchmark(log);
+
+	Logger<char>::setFileBackend(FileBackend::Mapped);
+	std::cout << "\nMemory mapped file :\n";
+	benchmark(log);
 
 	return 0;
 }
@@ -3,13 +3,8 @@
 
 using namespace aricanli::general;
 
-int main() {
-LoggerW::setLogOutput(L"basicLog/log/log.txt");
-	LoggerW::setLogPriority(LogPriority::Debug);
-	auto log = LoggerW::getInstance();
-	log->setFileLimit(10*1024*1024);
-	log->setFormatter(L"%t %m");
-	log->log(LogPriority::Quiet);
+// Time 100.000 calls of each level with the selected file backend
+void benchmark(std::shared_ptr<LoggerW> log) {
 
 	auto start1 = std::chrono::high_resolution_clock::now();
 	for (int i = 0; i < 100'000; i++)
@@ -65,8 +60,27 @@ LoggerW::setLogOutput(L"basicLog/log/log.txt");
 		<< "\nError : " << elapsed3.count() << "\nWarning" << elapsed4.count()
 		<< "\nInfo : " << elapsed5.count() << "\nVerbose" << elapsed6.count()
 		<< "\nDebug : " << elapsed7.count() << "\nTrace" << elapsed8.count();
+	std::cout << "\n";
+}
+
+int main() {
+LoggerW::setLogOutput(L"basicLog/log/log.txt");
+	LoggerW::setLogPriority(LogPriority::Debug);
+	auto log = LoggerW::getInstance();
+	log->setFileLimit(10*1024*1024);
+	log->setFormatter(L"%t %m");
+	log->log(LogPriority::Quiet);
+
+	std::cout << "std::basic_ofstream :\n";
+	benchmark(log);
 
+	LoggerW::setFileBackend(FileBackend::Posix);
+	std::cout << "\nPosix file descriptor :\n";
+	benchmark(log);
 
+	LoggerW::setFileBackend(FileBackend::Mapped);
+	std::cout << "\nMemory mapped file :\n";
+	benchmark(log);
 
 	return 0;
 }
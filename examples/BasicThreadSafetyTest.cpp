@@ -1,11 +1,13 @@
 ﻿#include <iostream>
 #include <vector>
+#include <thread>
+#include <chrono>
 #include "Logger.h"
 
 using namespace aricanli::general;
 
 
-void test(std::weak_ptr<Logger<char>> log_ptr, size_t i) {
+void test(std::weak_ptr<Logger<char>> log_ptr) {
 
 	auto t_sharedlockptr = log_ptr.lock();
 
@@ -15,24 +17,49 @@ void test(std::weak_ptr<Logger<char>> log_ptr, size_t i) {
 	}
 }
 
+// Run test() on every hardware thread and return written messages per second
+double run(std::shared_ptr<Logger<char>> log, size_t sizeThread) {
+
+	std::vector<std::thread> t_vec;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (size_t i = 0; i < sizeThread; i++) {
+		t_vec.push_back(std::thread(test, log));
+	}
+
+	for (auto& th : t_vec)
+		th.join();
+
+	auto producersDone = std::chrono::high_resolution_clock::now();
+	log->flush();
+	auto finish = std::chrono::high_resolution_clock::now();
+
+	std::chrono::duration<double> elapsedProducers = producersDone - start;
+	std::chrono::duration<double> elapsed = finish - start;
+	std::cout << "  producers : " << elapsedProducers.count() << " s, total with flush : " << elapsed.count() << " s\n";
+	return (sizeThread * 100'000) / elapsed.count();
+}
+
 
 int main() {
 	Logger<char>::setLogOutput("log/log.txt");
 	Logger<char>::setLogPriority(LogPriority::Fatal);
 	auto log = Logger<char>::getInstance();
 	const size_t sizeThread = std::thread::hardware_concurrency();
-	std::vector<std::thread> t_vec;
 
-	
+	std::cout << "Threads : " << sizeThread << "\nSync (mutex) :\n";
+	double syncRate = run(log, sizeThread);
 
-	for (size_t i = 0; i < sizeThread; i++) {
-		t_vec.push_back(std::thread(test, log, i));
-	}
-		
+	Logger<char>::setAsyncMode(true);
+	std::cout << "Async (queue + writer thread) :\n";
+	double asyncRate = run(log, sizeThread);
 
-	for (auto& th : t_vec)
-		th.join();
+	Logger<char>::setDeferredFormat(true);
+	std::cout << "Async with deferred formatting :\n";
+	double deferredRate = run(log, sizeThread);
+	Logger<char>::setAsyncMode(false);
 
+	std::cout << "Sync : " << syncRate << " msg/s\nAsync : " << asyncRate << " msg/s\nDeferred : " << deferredRate << " msg/s\n";
 
 	return 0;
 }
@@ -0,0 +1,32 @@
+#include <iostream>
+#include "Logger.h"
+
+using namespace aricanli::general;
+
+int main() {
+
+	auto log = Logger<char>::getInstance();
+	log->setFormatter("%m");
+
+	// console shows Warning and above
+	auto console = std::make_shared<ConsoleSink<char>>();
+	console->setLevel(LogPriority::Warning);
+
+	// file sink keeps everything with a timestamp
+	auto file = std::make_shared<FileSink<char>>("log/multi.txt");
+	file->setFormatter("%t %m");
+	file->setFileRotation(3);
+
+	log->setSinks({ console, file });
+
+	LOG_ERROR_C("connection lost, retry in", 5, "s");
+	LOG_WARNING_C("slow response :", 1.25, "s");
+	LOG_INFO_C("request served");
+	LOG_TRACE_C("cache hit ratio :", 0.93);
+
+	// records below Info are skipped before their arguments are evaluated
+	file->setLevel(LogPriority::Info);
+	LOG_TRACE_C("not written");
+
+	return 0;
+}
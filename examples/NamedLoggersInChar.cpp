@@ -0,0 +1,34 @@
+#include <iostream>
+#include "Logger.h"
+
+using namespace aricanli::general;
+
+int main() {
+
+	// default logger writes everything to the console
+	Logger<char>::setFormatter("%m");
+
+	// "net" keeps its own file, level and pattern
+	auto& net = getLogger("net");
+	net.setLogOutput("log/net.txt");
+	net.setLogFormat();
+	net.setFormatter("%t %m");
+	net.setLogPriority(LogPriority::Info);
+
+	// "db" writes asynchronously to its own file
+	auto& db = getLogger("db");
+	db.setLogOutput("log/db.txt");
+	db.setLogFormat();
+	db.setAsyncMode(true);
+
+	LOG_INFO_C("service started");
+	LOG_INFO_L(net, "connected to", "10.0.0.1", "port", 8080);
+	LOG_DEBUG_L(net, "not written, net accepts Info and above");
+	LOG_WARNING_L(db, "slow query :", 1.25, "s");
+
+	// the same name returns the same logger
+	LOG_ERROR_L(getLogger("net"), "connection lost");
+
+	db.flush();
+	return 0;
+}
@@ -0,0 +1,29 @@
+#include <iostream>
+#include "Logger.h"
+
+using namespace aricanli::general;
+
+int main() {
+
+	auto log = Logger<char>::getInstance();
+
+	// console shows the records as text, named arguments as key=value
+	log->setFormatter("%t %m");
+
+	// file sink writes one JSON object per line
+	auto file = std::make_shared<FileSink<char>>("log/structured.json");
+	file->setFormatter("%t %m %f %l", formatPattern::JSON);
+	log->addSink(file);
+
+	// logfmt for a second file
+	auto logfmt = std::make_shared<FileSink<char>>("log/structured.logfmt");
+	logfmt->setFormatter("%t %m", formatPattern::LOGFMT);
+	log->addSink(logfmt);
+
+	std::string user = "jane \"jd\" doe";
+	LOG_INFO_C("user logged in", field("user", user), field("attempt", 2), field("admin", false));
+	LOG_WARNING_C("slow response", field("ms", 1250.5), field("path", "/api/v1/items"));
+	LOG_ERROR_C("connection lost, retry in", 5, "s");
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <ios>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace aricanli {
+	namespace general {
+
+		// Class AppendBuffer<T>
+		// Stream buffer which appends everything written to it to a basic_string<T>
+		template <typename T>
+		class AppendBuffer : public std::basic_streambuf<T> {
+		public:
+			using int_type = typename std::basic_streambuf<T>::int_type;
+			using traits_type = typename std::basic_streambuf<T>::traits_type;
+
+			void setTarget(std::basic_string<T>* t_out) noexcept {
+				m_out = t_out;
+			}
+
+		protected:
+			int_type overflow(int_type c) override {
+				if (!traits_type::eq_int_type(c, traits_type::eof()))
+					m_out->push_back(traits_type::to_char_type(c));
+				return traits_type::not_eof(c);
+			}
+
+			std::streamsize xsputn(const T* s, std::streamsize n) override {
+				m_out->append(s, static_cast<size_t>(n));
+				return n;
+			}
+
+		protected:
+			std::basic_string<T>* m_out = nullptr;
+		}; // end of class
+
+		// Class AppendStream<T>
+		// basic_ostream<T> over AppendBuffer<T>, one per thread.
+		// Unlike basic_ostringstream nothing is allocated per message: the text goes
+		// straight into a string whose capacity is kept between the calls.
+		// Example:
+		// std::string out;
+		// AppendStream<char>::local().target(out) << 42 << " ";
+		template <typename T>
+		class AppendStream : public std::basic_ostream<T> {
+		public:
+			AppendStream() : std::basic_ostream<T>(nullptr) {
+				this->init(&m_buffer);
+			}
+
+			AppendStream(const AppendStream&) = delete;
+			AppendStream& operator=(const AppendStream&) = delete;
+
+			/*
+			* Append to given string from now on, formatting flags are reset to their defaults
+			* @param out: basic_string<T>
+			* @return: *this
+			*/
+			AppendStream& target(std::basic_string<T>& out) {
+				m_buffer.setTarget(&out);
+				this->clear();
+				this->flags(std::ios_base::dec | std::ios_base::skipws);
+				this->precision(6);
+				this->width(0);
+				this->fill(this->widen(' '));
+				return *this;
+			}
+
+			/*
+			* Stream of the calling thread
+			* @return: AppendStream<T>&
+			*/
+			static AppendStream& local() {
+				thread_local AppendStream stream;
+				return stream;
+			}
+
+		protected:
+			AppendBuffer<T> m_buffer;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,382 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+#if __cplusplus >= 201703L
+#include <filesystem>
+#endif
+#if defined TLOG_USE_ZLIB
+	#include <zlib.h>
+#endif
+#if defined TLOG_USE_ZSTD
+	#include <zstd.h>
+#endif
+#if defined __linux__
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		// Compression enum class
+		// Codec of rotated log files, the codecs are compiled in with
+		// -DTLOG_USE_ZLIB (link zlib) and -DTLOG_USE_ZSTD (link libzstd)
+		enum class Compression {
+			None,
+			Gzip,	// .gz, falls back to None without zlib
+			Zstd	// .zst, falls back to Gzip without libzstd
+		};
+
+#if __cplusplus >= 201703L
+		namespace archive {
+			constexpr size_t chunkSize = 64 * 1024;
+
+			/*
+			* Get the codec which is compiled in for the requested one
+			* @param t_requested: Compression
+			* @return: Compression
+			*/
+			inline Compression resolve(Compression t_requested) noexcept {
+#if defined TLOG_USE_ZSTD
+				if (t_requested == Compression::Zstd)
+					return Compression::Zstd;
+#endif
+#if defined TLOG_USE_ZLIB
+				if (t_requested != Compression::None)
+					return Compression::Gzip;
+#endif
+				(void)t_requested;
+				return Compression::None;
+			}
+
+			inline const char* extension(Compression t_compression) noexcept {
+				switch (t_compression) {
+				case Compression::Gzip:
+					return ".gz";
+				case Compression::Zstd:
+					return ".zst";
+				default:
+					return "";
+				}
+			}
+
+			/*
+			* Compress a file into a gzip member
+			* @return: false if a file can not be read or written
+			*/
+			inline bool gzipFile(const std::filesystem::path& t_from, const std::filesystem::path& t_to) {
+#if defined TLOG_USE_ZLIB
+				std::ifstream in(t_from, std::ios::binary);
+				std::ofstream out(t_to, std::ios::binary | std::ios::trunc);
+				if (!in || !out)
+					return false;
+
+				z_stream stream{};
+				// 16 + 15: gzip header and a 32 KB window
+				if (deflateInit2(&stream, 6, Z_DEFLATED, 16 + 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+					return false;
+				std::vector<char> input(chunkSize);
+				std::vector<char> output(chunkSize);
+				bool ok = true;
+				int flush = Z_NO_FLUSH;
+				do {
+					in.read(input.data(), static_cast<std::streamsize>(input.size()));
+					if (in.bad()) {
+						ok = false;
+						break;
+					}
+					flush = in.eof() ? Z_FINISH : Z_NO_FLUSH;
+					stream.next_in = reinterpret_cast<Bytef*>(input.data());
+					stream.avail_in = static_cast<uInt>(in.gcount());
+					do {
+						stream.next_out = reinterpret_cast<Bytef*>(output.data());
+						stream.avail_out = static_cast<uInt>(output.size());
+						deflate(&stream, flush);
+						out.write(output.data(), static_cast<std::streamsize>(output.size() - stream.avail_out));
+					} while (stream.avail_out == 0);
+				} while (flush != Z_FINISH && out);
+				deflateEnd(&stream);
+				out.close();
+				return ok && !out.fail();
+#else
+				(void)t_from;
+				(void)t_to;
+				return false;
+#endif
+			}
+
+			/*
+			* Compress a file into a zstd frame
+			* @return: false if a file can not be read or written
+			*/
+			inline bool zstdFile(const std::filesystem::path& t_from, const std::filesystem::path& t_to) {
+#if defined TLOG_USE_ZSTD
+				std::ifstream in(t_from, std::ios::binary);
+				std::ofstream out(t_to, std::ios::binary | std::ios::trunc);
+				if (!in || !out)
+					return false;
+
+				std::unique_ptr<ZSTD_CCtx, size_t(*)(ZSTD_CCtx*)> context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+				if (!context)
+					return false;
+				ZSTD_CCtx_setParameter(context.get(), ZSTD_c_compressionLevel, 3);
+				std::vector<char> input(ZSTD_CStreamInSize());
+				std::vector<char> output(ZSTD_CStreamOutSize());
+				bool last = false;
+				while (!last && out) {
+					in.read(input.data(), static_cast<std::streamsize>(input.size()));
+					if (in.bad())
+						return false;
+					last = in.eof();
+					ZSTD_inBuffer source{ input.data(), static_cast<size_t>(in.gcount()), 0 };
+					bool finished = false;
+					while (!finished) {
+						ZSTD_outBuffer target{ output.data(), output.size(), 0 };
+						size_t remaining = ZSTD_compressStream2(context.get(), &target, &source, last ? ZSTD_e_end : ZSTD_e_continue);
+						if (ZSTD_isError(remaining))
+							return false;
+						out.write(output.data(), static_cast<std::streamsize>(target.pos));
+						finished = last ? remaining == 0 : source.pos == source.size;
+					}
+				}
+				out.close();
+				return !out.fail();
+#else
+				(void)t_from;
+				(void)t_to;
+				return false;
+#endif
+			}
+
+			/*
+			* Lower the CPU and I/O priority of the calling thread
+			*/
+			inline void lowerPriority() noexcept {
+#if defined __linux__
+				// the nice value and the I/O class are per thread on Linux
+				pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+				(void)setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19);
+#if defined SYS_ioprio_set
+				const int whoProcess = 1;
+				const int classIdle = 3 << 13;
+				(void)syscall(SYS_ioprio_set, whoProcess, 0, classIdle);
+#endif
+#endif
+			}
+		} // end of archive namespace
+
+		// Class FileArchiver
+		// Background stage for rotated log files: compresses a file, deletes the original
+		// and then applies the retention policy to the rotated files of the log.
+		// Runs on one thread with the lowest CPU and I/O priority. FileSink only adds a job
+		// under a short lock, it never waits for the compression.
+		// The archiver is shared by the file sinks which use it, the last one to go
+		// finishes the waiting jobs and joins the thread.
+		class FileArchiver {
+		public:
+			struct Job {
+				std::filesystem::path file;		// rotated file
+				std::filesystem::path logPath;	// active log file, its rotated files are matched by name
+				Compression compression = Compression::None;
+				size_t maxFiles = 0;			// 0 keeps every file
+				unsigned long long maxBytes = 0;	// 0 for no limit
+			};
+
+			FileArchiver() = default;
+			FileArchiver(const FileArchiver&) = delete;
+			FileArchiver& operator=(const FileArchiver&) = delete;
+			~FileArchiver() noexcept {
+				{
+					std::lock_guard<std::mutex> _lock(m_mutex);
+					m_stop = true;
+				}
+				m_wake.notify_one();
+				if (m_thread.joinable())
+					m_thread.join();
+			}
+
+			/*
+			* Get the archiver shared by the file sinks, create it if no sink holds it
+			* @return: shared_ptr<FileArchiver>
+			*/
+			static std::shared_ptr<FileArchiver> shared() {
+				static std::mutex mutex;
+				static std::weak_ptr<FileArchiver> current;
+				std::lock_guard<std::mutex> _lock(mutex);
+				std::shared_ptr<FileArchiver> archiver = current.lock();
+				if (!archiver) {
+					archiver = std::make_shared<FileArchiver>();
+					current = archiver;
+				}
+				return archiver;
+			}
+
+			/*
+			* Queue a rotated file, the thread is started on first use
+			* @param t_job: Job
+			*/
+			void push(Job t_job) {
+				{
+					std::lock_guard<std::mutex> _lock(m_mutex);
+					m_jobs.push_back(std::move(t_job));
+					if (!m_thread.joinable())
+						m_thread = std::thread(&FileArchiver::run, this);
+				}
+				m_wake.notify_one();
+			}
+
+			/*
+			* Block until every queued file is processed
+			*/
+			void wait() {
+				std::unique_lock<std::mutex> _lock(m_mutex);
+				m_idle.wait(_lock, [this] { return m_jobs.empty() && !m_busy; });
+			}
+
+		protected:
+			void run() {
+
+				archive::lowerPriority();
+				std::unique_lock<std::mutex> _lock(m_mutex);
+				for (;;) {
+					m_wake.wait(_lock, [this] { return m_stop || !m_jobs.empty(); });
+					if (m_jobs.empty())
+						break;
+					Job job = std::move(m_jobs.front());
+					m_jobs.pop_front();
+					m_busy = true;
+					_lock.unlock();
+					try {
+						compress(job);
+						applyRetention(job);
+					}
+					catch (...) {
+					}
+					_lock.lock();
+					m_busy = false;
+					if (m_jobs.empty())
+						m_idle.notify_all();
+				}
+			}
+
+			/*
+			* Write file.gz or file.zst next to the file and delete the file
+			* a partly written output is kept as .tmp and removed on failure
+			*/
+			static void compress(const Job& t_job) {
+
+				const Compression codec = archive::resolve(t_job.compression);
+				if (codec == Compression::None)
+					return;
+				std::filesystem::path target = t_job.file;
+				target += archive::extension(codec);
+				std::filesystem::path temp = target;
+				temp += ".tmp";
+
+				bool ok = codec == Compression::Zstd ? archive::zstdFile(t_job.file, temp) : archive::gzipFile(t_job.file, temp);
+				std::error_code ec;
+				if (ok) {
+					// keep the time of the log file as gzip does, the retention orders the files by it
+					auto time = std::filesystem::last_write_time(t_job.file, ec);
+					if (!ec)
+						std::filesystem::last_write_time(temp, time, ec);
+					std::filesystem::rename(temp, target, ec);
+				}
+				if (!ok || ec) {
+					std::filesystem::remove(temp, ec);
+					return;
+				}
+				std::filesystem::remove(t_job.file, ec);
+			}
+
+			/*
+			* Delete the oldest rotated files beyond the file count or the total size
+			* Rotated files of log.txt are log.<anything>.txt with an optional .gz or .zst,
+			* the newest one is always kept
+			*/
+			static void applyRetention(const Job& t_job) {
+
+				if (t_job.maxFiles == 0 && t_job.maxBytes == 0)
+					return;
+
+				using string_type = std::filesystem::path::string_type;
+				const string_type prefix = t_job.logPath.stem().native() + std::filesystem::path::string_type(1, '.');
+				const string_type extension = t_job.logPath.extension().native();
+				const string_type active = t_job.logPath.filename().native();
+				auto endsWith = [](const string_type& t_text, const string_type& t_suffix) {
+					return t_text.size() >= t_suffix.size() && t_text.compare(t_text.size() - t_suffix.size(), t_suffix.size(), t_suffix) == 0;
+				};
+
+				struct Rotated {
+					std::filesystem::path path;
+					std::filesystem::file_time_type time;
+					unsigned long long size;
+				};
+				std::vector<Rotated> files;
+				std::error_code ec;
+				std::filesystem::path directory = t_job.logPath.parent_path();
+				if (directory.empty())
+					directory = std::filesystem::path(".");
+				for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+					const string_type name = it->path().filename().native();
+					if (name == active || name.compare(0, prefix.size(), prefix) != 0)
+						continue;
+					string_type base = name;
+					for (const char* suffix : { ".gz", ".zst" }) {
+						string_type compressed(suffix, suffix + std::char_traits<char>::length(suffix));
+						if (endsWith(base, compressed)) {
+							base.resize(base.size() - compressed.size());
+							break;
+						}
+					}
+					if (!endsWith(base, extension) || base.size() <= prefix.size() + extension.size())
+						continue;
+					std::error_code fileEc;
+					auto time = std::filesystem::last_write_time(it->path(), fileEc);
+					auto size = std::filesystem::file_size(it->path(), fileEc);
+					if (!fileEc)
+						files.push_back({ it->path(), time, static_cast<unsigned long long>(size) });
+				}
+
+				// the time of a file is coarse, files of the same second are ordered by their counter
+				std::sort(files.begin(), files.end(), [](const Rotated& a, const Rotated& b) {
+					if (a.time != b.time)
+						return a.time > b.time;
+					const string_type& nameA = a.path.native();
+					const string_type& nameB = b.path.native();
+					if (nameA.size() != nameB.size())
+						return nameA.size() > nameB.size();
+					return nameA > nameB;
+				});
+				unsigned long long total = 0;
+				for (size_t i = 0; i < files.size(); i++) {
+					total += files[i].size;
+					bool overCount = t_job.maxFiles != 0 && i >= t_job.maxFiles;
+					bool overSize = t_job.maxBytes != 0 && total > t_job.maxBytes && i != 0;
+					if (overCount || overSize)
+						std::filesystem::remove(files[i].path, ec);
+				}
+			}
+
+		protected:
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::condition_variable m_idle;
+			std::deque<Job> m_jobs;
+			std::thread m_thread;
+			bool m_busy = false;
+			bool m_stop = false;
+		}; // end of class
+#endif
+
+	} // end of general namespace
+} // end of aricanli namespace
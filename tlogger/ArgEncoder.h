@@ -0,0 +1,392 @@
+#pragma once
+#include <cstring>
+#include <cstddef>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include "BinaryLog.h"
+#include "AppendStream.h"
+#include "TextConvert.h"
+#include "Field.h"
+
+#ifndef TLOG_RECORD_ARGS_SIZE
+#define TLOG_RECORD_ARGS_SIZE 256
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		// Struct ArgBuffer
+		// Fixed size inline storage of the encoded arguments of one deferred record
+		// Every value is stored at its natural alignment, so the decoder can read strings in place
+		struct ArgBuffer {
+			ArgBuffer() noexcept = default;
+
+			ArgBuffer(const ArgBuffer& other) noexcept : size(other.size) {
+				std::memcpy(data, other.data, size);
+			}
+
+			ArgBuffer& operator=(const ArgBuffer& other) noexcept {
+				size = other.size;
+				std::memcpy(data, other.data, size);
+				return *this;
+			}
+
+			/*
+			* Append a trivially copyable value
+			* @param value: V
+			* @return: false if the buffer is too small
+			*/
+			template <typename V>
+			bool put(const V& value) noexcept {
+				size_t offset = align(size, alignof(V));
+				if (offset + sizeof(V) > sizeof(data))
+					return false;
+				std::memcpy(data + offset, &value, sizeof(V));
+				size = offset + sizeof(V);
+				return true;
+			}
+
+			/*
+			* Append length and a null terminated copy of given characters
+			* @param str: const C*
+			* @param length: number of characters
+			* @return: false if the buffer is too small
+			*/
+			template <typename C>
+			bool putChars(const C* str, size_t length) noexcept {
+				if (!put(length))
+					return false;
+				size_t offset = align(size, alignof(C));
+				if (offset + (length + 1) * sizeof(C) > sizeof(data))
+					return false;
+				std::memcpy(data + offset, str, length * sizeof(C));
+				std::memset(data + offset + length * sizeof(C), 0, sizeof(C));
+				size = offset + (length + 1) * sizeof(C);
+				return true;
+			}
+
+			/*
+			* Read a value written by put()
+			* @param t_data: encoded arguments
+			* @param offset: read position, moved past the value
+			*/
+			template <typename V>
+			static V get(const unsigned char* t_data, size_t& offset) noexcept {
+				V value;
+				offset = align(offset, alignof(V));
+				std::memcpy(&value, t_data + offset, sizeof(V));
+				offset += sizeof(V);
+				return value;
+			}
+
+			/*
+			* Read characters written by putChars()
+			* @param t_data: encoded arguments
+			* @param offset: read position, moved past the characters
+			* @param length: number of characters
+			*/
+			template <typename C>
+			static const C* getChars(const unsigned char* t_data, size_t& offset, size_t& length) noexcept {
+				length = get<size_t>(t_data, offset);
+				offset = align(offset, alignof(C));
+				auto str = reinterpret_cast<const C*>(t_data + offset);
+				offset += (length + 1) * sizeof(C);
+				return str;
+			}
+
+			static size_t align(size_t offset, size_t alignment) noexcept {
+				return (offset + alignment - 1) & ~(alignment - 1);
+			}
+
+			alignas(8) unsigned char data[TLOG_RECORD_ARGS_SIZE];
+			size_t size = 0;
+		};
+
+		/*
+		* Add an arithmetic value to a binary record with the tag of its type
+		*/
+		inline void addBinaryValue(BinaryLogWriter& writer, bool value) {
+			writer.addBool(value);
+		}
+
+		inline void addBinaryValue(BinaryLogWriter& writer, char value) {
+			writer.addChar(static_cast<unsigned char>(value));
+		}
+
+		inline void addBinaryValue(BinaryLogWriter& writer, signed char value) {
+			writer.addChar(static_cast<unsigned char>(value));
+		}
+
+		inline void addBinaryValue(BinaryLogWriter& writer, unsigned char value) {
+			writer.addChar(value);
+		}
+
+		inline void addBinaryValue(BinaryLogWriter& writer, wchar_t value) {
+			writer.addChar(static_cast<uint32_t>(value));
+		}
+
+		inline void addBinaryValue(BinaryLogWriter& writer, float value) {
+			writer.addFloat(value);
+		}
+
+		template <typename A>
+		typename std::enable_if<std::is_floating_point<A>::value>::type addBinaryValue(BinaryLogWriter& writer, A value) {
+			writer.addDouble(static_cast<double>(value));
+		}
+
+		template <typename A>
+		typename std::enable_if<std::is_integral<A>::value && std::is_signed<A>::value>::type addBinaryValue(BinaryLogWriter& writer, A value) {
+			writer.addInt(static_cast<int64_t>(value));
+		}
+
+		template <typename A>
+		typename std::enable_if<std::is_integral<A>::value && !std::is_signed<A>::value>::type addBinaryValue(BinaryLogWriter& writer, A value) {
+			writer.addUInt(static_cast<uint64_t>(value));
+		}
+
+		// Struct ArgCodec<T, A>
+		// Encode one argument of type A on the calling thread and decode it
+		// into a basic_string<T> on the writer thread or into a binary record.
+		// Default: types without a compact form are streamed with operator<< when
+		// they are logged and only the resulting text is copied.
+		template <typename T, typename A, typename Enable = void>
+		struct ArgCodec {
+			static bool encode(ArgBuffer& buffer, const A& arg) {
+				thread_local std::basic_string<T> str;
+				str.clear();
+				AppendStream<T>::local().target(str) << arg;
+				return buffer.putChars(str.data(), str.size());
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				size_t length;
+				const T* str = ArgBuffer::getChars<T>(data, offset, length);
+				appendChars(out, str, length);
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				size_t length;
+				const T* str = ArgBuffer::getChars<T>(data, offset, length);
+				writer.addString(str, length);
+			}
+		};
+
+		// ints, doubles, chars and bool are stored by value
+		template <typename T, typename A>
+		struct ArgCodec<T, A, typename std::enable_if<std::is_arithmetic<A>::value>::type> {
+			static bool encode(ArgBuffer& buffer, A arg) noexcept {
+				return buffer.put(arg);
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				appendValue(out, ArgBuffer::get<A>(data, offset));
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				addBinaryValue(writer, ArgBuffer::get<A>(data, offset));
+			}
+		};
+
+		// constant character arrays may be local, they are copied with the length of the array
+		template <typename T, typename C, size_t N>
+		struct ArgCodec<T, const C[N], typename std::enable_if<IsCharType<C>::value>::type> {
+			static bool encode(ArgBuffer& buffer, const C(&arg)[N]) noexcept {
+				return buffer.putChars(arg, literalLength<N>(arg));
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				appendChars(out, str, length);
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				writer.addString(str, length);
+			}
+		};
+
+		// strings marked with literal() are stored by pointer
+		template <typename T, typename C>
+		struct ArgCodec<T, Literal<C>, typename std::enable_if<IsCharType<C>::value>::type> {
+			static bool encode(ArgBuffer& buffer, const Literal<C>& arg) noexcept {
+				return buffer.put(arg.str) && buffer.put(arg.length);
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				const C* str = ArgBuffer::get<const C*>(data, offset);
+				appendChars(out, str, ArgBuffer::get<size_t>(data, offset));
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				const C* str = ArgBuffer::get<const C*>(data, offset);
+				(void)ArgBuffer::get<size_t>(data, offset);
+				writer.addLiteral(str);
+			}
+		};
+
+		// writable character arrays may change after the call, they are copied
+		template <typename T, typename C, size_t N>
+		struct ArgCodec<T, C[N], typename std::enable_if<IsCharType<C>::value>::type> {
+			static bool encode(ArgBuffer& buffer, const C(&arg)[N]) noexcept {
+				return buffer.putChars(arg, std::char_traits<C>::length(arg));
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				appendChars(out, str, length);
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				writer.addString(str, length);
+			}
+		};
+
+		// character pointers are copied
+		template <typename T, typename C>
+		struct ArgCodec<T, C*, typename std::enable_if<IsCharType<typename std::remove_const<C>::type>::value>::type> {
+			using Char = typename std::remove_const<C>::type;
+
+			static bool encode(ArgBuffer& buffer, const Char* arg) noexcept {
+				return buffer.putChars(arg, std::char_traits<Char>::length(arg));
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				size_t length;
+				const Char* str = ArgBuffer::getChars<Char>(data, offset, length);
+				appendChars(out, str, length);
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				size_t length;
+				const Char* str = ArgBuffer::getChars<Char>(data, offset, length);
+				writer.addString(str, length);
+			}
+		};
+
+		// owned strings are copied
+		template <typename T, typename C>
+		struct ArgCodec<T, std::basic_string<C>, typename std::enable_if<IsCharType<C>::value>::type> {
+			static bool encode(ArgBuffer& buffer, const std::basic_string<C>& arg) noexcept {
+				return buffer.putChars(arg.data(), arg.size());
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char* data, size_t& offset, Out& out) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				appendChars(out, str, length);
+			}
+
+			static void toBinary(const unsigned char* data, size_t& offset, BinaryLogWriter& writer) {
+				size_t length;
+				const C* str = ArgBuffer::getChars<C>(data, offset, length);
+				writer.addString(str, length);
+			}
+		};
+
+		// fields refer to their value, records with fields are formatted on the calling thread
+		template <typename T, typename C, typename V>
+		struct ArgCodec<T, Field<C, V>> {
+			static bool encode(ArgBuffer&, const Field<C, V>&) noexcept {
+				return false;
+			}
+
+			template <typename Out>
+			static void decode(const unsigned char*, size_t&, Out&) { }
+
+			static void toBinary(const unsigned char*, size_t&, BinaryLogWriter&) { }
+		};
+
+		// Stored type of an argument: arrays keep their const qualifier, everything else drops it
+		template <typename Arg>
+		using StoredArg = typename std::conditional<std::is_array<typename std::remove_reference<Arg>::type>::value,
+			typename std::remove_reference<Arg>::type,
+			typename std::remove_cv<typename std::remove_reference<Arg>::type>::type>::type;
+
+		// Struct ArgFormat<T>
+		// Functions which read the encoded arguments of one argument list back
+		template <typename T>
+		struct ArgFormat {
+			void (*decode)(const unsigned char*, std::basic_string<T>&);
+			void (*toBinary)(const unsigned char*, BinaryLogWriter&);
+			void (*decodeText)(const unsigned char*, FixedText&);
+		};
+
+		// Class ArgDecoder<T, A...>
+		// One instantiation per argument list, i.e. per call site signature.
+		// The address of its ArgFormat is stored in the record, so the writer thread knows
+		// how to read the buffer back.
+		template <typename T, typename ...A>
+		class ArgDecoder {
+		public:
+			/*
+			* Get the ArgFormat of this argument list
+			* @return: const ArgFormat<T>*, same address for every call
+			*/
+			static const ArgFormat<T>* format() noexcept {
+				static const ArgFormat<T> argFormat = { &decode, &toBinary, &decodeText };
+				return &argFormat;
+			}
+
+			/*
+			* Encode given arguments into the buffer
+			* @return: false if they do not fit, buffer content is undefined then
+			*/
+			template <typename ...Args>
+			static bool encode(ArgBuffer& buffer, const Args &...args) {
+				bool fits = true;
+				using unused = int[];
+				(void)unused {
+					0, (fits = fits && ArgCodec<T, A>::encode(buffer, args), 0)...
+				};
+				return fits;
+			}
+
+			/*
+			* Append the encoded arguments separated by a space, same layout as Formatter::formatMessage()
+			*/
+			static void decode(const unsigned char* data, std::basic_string<T>& out) {
+				size_t offset = 0;
+				using unused = int[];
+				(void)unused {
+					0, (ArgCodec<T, A>::decode(data, offset, out), out += T(' '), 0)...
+				};
+			}
+
+			/*
+			* Append the encoded arguments as UTF-8 without allocating, used by the crash handler
+			*/
+			static void decodeText(const unsigned char* data, FixedText& out) noexcept {
+				size_t offset = 0;
+				using unused = int[];
+				(void)unused {
+					0, (ArgCodec<T, A>::decode(data, offset, out), appendChars(out, " ", 1), 0)...
+				};
+			}
+
+			/*
+			* Add the encoded arguments to a binary record
+			*/
+			static void toBinary(const unsigned char* data, BinaryLogWriter& writer) {
+				size_t offset = 0;
+				using unused = int[];
+				(void)unused {
+					0, (ArgCodec<T, A>::toBinary(data, offset, writer), 0)...
+				};
+			}
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
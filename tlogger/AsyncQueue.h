@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace aricanli {
+	namespace general {
+
+		// Class AsyncQueue<Record>
+		// Bounded lock-free queue used by the asynchronous logging backend.
+		// Every slot carries a sequence number, so producers claim a slot with a single
+		// compare-and-swap and never block each other or the consumer.
+		// Capacity is rounded up to a power of two.
+		// Records are swapped in and out of the slots, so the buffers of a consumed record
+		// go back to the producer and are reused instead of allocated again.
+		// Example:
+		// AsyncQueue<LogRecord<char>> queue(8192);
+		// queue.tryPush(record);
+		// while (queue.tryPop(record)) { ... }
+		template <typename Record>
+		class AsyncQueue {
+		public:
+			explicit AsyncQueue(size_t t_capacity) {
+				size_t capacity = 2;
+				while (capacity < t_capacity)
+					capacity <<= 1;
+
+				m_mask = capacity - 1;
+				m_slots.reset(new Slot[capacity]);
+				for (size_t i = 0; i < capacity; i++)
+					m_slots[i].sequence.store(i, std::memory_order_relaxed);
+				m_enqueuePos.store(0, std::memory_order_relaxed);
+				m_dequeuePos.store(0, std::memory_order_relaxed);
+			}
+
+			AsyncQueue(const AsyncQueue&) = delete;
+			AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+			/*
+			* Swap a record into the queue without blocking
+			* @param t_record: Record, receives the consumed record of the slot on success
+			* @return: false if the queue is full, t_record is unchanged then
+			*/
+			bool tryPush(Record& t_record) {
+				Slot* slot;
+				size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+				for (;;) {
+					slot = &m_slots[pos & m_mask];
+					size_t seq = slot->sequence.load(std::memory_order_acquire);
+					intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+					if (diff == 0) {
+						if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+							break;
+					}
+					else if (diff < 0) {
+						return false;
+					}
+					else {
+						pos = m_enqueuePos.load(std::memory_order_relaxed);
+					}
+				}
+				using std::swap;
+				swap(slot->record, t_record);
+				slot->sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+
+			/*
+			* Swap the oldest record out of the queue without blocking
+			* @param t_record: Record, its previous content is left in the slot for reuse
+			* @return: false if the queue is empty
+			*/
+			bool tryPop(Record& t_record) {
+				size_t pos = 0;
+				Slot* slot = claimOldest(pos);
+				if (slot == nullptr)
+					return false;
+				using std::swap;
+				swap(slot->record, t_record);
+				slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+
+			/*
+			* Pass the oldest record to a function and release its slot, the record stays
+			* in the slot, nothing is moved or freed, used by the crash handler
+			* @param t_visit: function taking const Record&
+			* @return: false if the queue is empty
+			*/
+			template <typename F>
+			bool tryConsume(F&& t_visit) {
+				size_t pos = 0;
+				Slot* slot = claimOldest(pos);
+				if (slot == nullptr)
+					return false;
+				t_visit(static_cast<const Record&>(slot->record));
+				slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+
+			/*
+			* Check whether a published record is waiting in the queue
+			* @return: bool
+			*/
+			bool empty() const noexcept {
+				size_t pos = m_dequeuePos.load(std::memory_order_acquire);
+				size_t seq = m_slots[pos & m_mask].sequence.load(std::memory_order_acquire);
+				return seq != pos + 1;
+			}
+
+			size_t capacity() const noexcept {
+				return m_mask + 1;
+			}
+
+		private:
+			struct Slot {
+				std::atomic<size_t> sequence;
+				Record record;
+			};
+
+			/*
+			* Claim the slot of the oldest published record for the consumer
+			* @param pos: receives the position of the slot
+			* @return: nullptr if the queue is empty
+			*/
+			Slot* claimOldest(size_t& pos) noexcept {
+				pos = m_dequeuePos.load(std::memory_order_relaxed);
+				for (;;) {
+					Slot* slot = &m_slots[pos & m_mask];
+					size_t seq = slot->sequence.load(std::memory_order_acquire);
+					intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+					if (diff == 0) {
+						if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+							return slot;
+					}
+					else if (diff < 0) {
+						return nullptr;
+					}
+					else {
+						pos = m_dequeuePos.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			std::unique_ptr<Slot[]> m_slots;
+			size_t m_mask = 0;
+			alignas(64) std::atomic<size_t> m_enqueuePos;
+			alignas(64) std::atomic<size_t> m_dequeuePos;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,239 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "FileWriter.h"
+
+namespace aricanli {
+	namespace general {
+
+		// FileFormat enum class
+		// Text : records formatted with the pattern of the formatter
+		// Binary : compact records decoded later by tools/tlog_decode
+		enum class FileFormat {
+			Text,
+			Binary
+		};
+
+		// Layout of a binary log, all numbers in host byte order
+		//	header      : "TLOGBIN" version(u8)             starts every opened file, resets the dictionaries
+		//	string      : 'D' id(u32) length(u32) UTF-8 bytes
+		//	call site   : 'C' id(u32) file string id(u32) line(u32) function string id(u32), 0 if unknown
+		//	record      : 'R' level(u8) nanoseconds since epoch(i64) call site id(u32) argument count(u16) arguments
+		//	arguments   : 'i' i64 | 'u' u64 | 'd' double | 'f' float | 'b' u8 | 'c' code point(u32)
+		//	              's' string id(u32) | 'S' length(u32) UTF-8 bytes
+		namespace binarylog {
+			const char magic[] = "TLOGBIN";
+			const unsigned char version = 1;
+
+			const char tagString = 'D';
+			const char tagSite = 'C';
+			const char tagRecord = 'R';
+
+			const char argInt = 'i';
+			const char argUInt = 'u';
+			const char argDouble = 'd';
+			const char argFloat = 'f';
+			const char argBool = 'b';
+			const char argChar = 'c';
+			const char argStringId = 's';
+			const char argString = 'S';
+		}
+
+		// Class BinaryLogWriter
+		// Encode records in the binary log layout.
+		// Static strings (marked with literal()) and call sites are written once into the
+		// dictionary and referenced by id afterwards.
+		// Example:
+		// BinaryLogWriter writer;
+		// writer.beginRecord(16, ns, site);
+		// writer.addInt(42);
+		// writer.addLiteral("connection lost");
+		// writer.endRecord();
+		// file.write(writer.data(), writer.size(), now);
+		// writer.clear();
+		class BinaryLogWriter {
+		public:
+			/*
+			* Forget the dictionaries, the next record starts with a header
+			* call it whenever a new file is opened
+			*/
+			void reset() {
+				m_strings.clear();
+				m_sites.clear();
+				m_out.clear();
+				m_out.append(binarylog::magic, sizeof(binarylog::magic) - 1);
+				m_out += static_cast<char>(binarylog::version);
+			}
+
+			/*
+			* Start a record
+			* @param level: numeric LogPriority
+			* @param ns: nanoseconds since epoch
+			* @param site: identity of the call site, nullptr if unknown
+			*/
+			void beginRecord(unsigned level, int64_t ns, const void* site) {
+				uint32_t siteId = site != nullptr ? siteIdOf(site, nullptr, 0, nullptr) : 0;
+				beginRecordWithSite(level, ns, siteId);
+			}
+
+			/*
+			* Start a record of a call site with its source location
+			* the location is written once per file, %f, %l and %F are read back from it
+			* @param level: numeric LogPriority
+			* @param ns: nanoseconds since epoch
+			* @param site: identity of the call site
+			* @param file: source file, nullptr if unknown
+			* @param line: source line, 0 if unknown
+			* @param function: function, nullptr if unknown
+			*/
+			void beginRecord(unsigned level, int64_t ns, const void* site, const char* file, unsigned line, const char* function) {
+				beginRecordWithSite(level, ns, siteIdOf(site, file, line, function));
+			}
+
+			void addInt(int64_t value) {
+				addArg(binarylog::argInt);
+				put(m_record, value);
+			}
+
+			void addUInt(uint64_t value) {
+				addArg(binarylog::argUInt);
+				put(m_record, value);
+			}
+
+			void addDouble(double value) {
+				addArg(binarylog::argDouble);
+				put(m_record, value);
+			}
+
+			void addFloat(float value) {
+				addArg(binarylog::argFloat);
+				put(m_record, value);
+			}
+
+			void addBool(bool value) {
+				addArg(binarylog::argBool);
+				m_record += static_cast<char>(value ? 1 : 0);
+			}
+
+			void addChar(uint32_t codePoint) {
+				addArg(binarylog::argChar);
+				put(m_record, codePoint);
+			}
+
+			/*
+			* Add a string with static storage duration, written once to the dictionary
+			*/
+			template <typename C>
+			void addLiteral(const C* str) {
+				addArg(binarylog::argStringId);
+				put(m_record, stringIdOf(str));
+			}
+
+			/*
+			* Add a string by value
+			*/
+			template <typename C>
+			void addString(const C* str, size_t length) {
+				addArg(binarylog::argString);
+				m_utf8.clear();
+				appendUtf8(m_utf8, str, length);
+				put(m_record, static_cast<uint32_t>(m_utf8.size()));
+				m_record += m_utf8;
+			}
+
+			/*
+			* Finish the record, its bytes follow the dictionary entries it needs
+			*/
+			void endRecord() {
+				std::memcpy(&m_record[m_argCountPos], &m_argCount, sizeof(m_argCount));
+				m_out += m_record;
+			}
+
+			const char* data() const noexcept {
+				return m_out.data();
+			}
+
+			size_t size() const noexcept {
+				return m_out.size();
+			}
+
+			/*
+			* Drop the bytes already written to the file
+			*/
+			void clear() noexcept {
+				m_out.clear();
+			}
+
+		protected:
+			template <typename V>
+			static void put(std::string& out, const V& value) {
+				out.append(reinterpret_cast<const char*>(&value), sizeof(V));
+			}
+
+			void beginRecordWithSite(unsigned level, int64_t ns, uint32_t siteId) {
+				m_record.clear();
+				m_record += binarylog::tagRecord;
+				m_record += static_cast<char>(level);
+				put(m_record, ns);
+				put(m_record, siteId);
+				m_argCountPos = m_record.size();
+				m_argCount = 0;
+				put(m_record, m_argCount);
+			}
+
+			void addArg(char tag) {
+				m_argCount++;
+				m_record += tag;
+			}
+
+			template <typename C>
+			uint32_t stringIdOf(const C* str) {
+				if (str == nullptr)
+					return 0;
+				auto found = m_strings.find(str);
+				if (found != m_strings.end())
+					return found->second;
+
+				uint32_t id = static_cast<uint32_t>(m_strings.size() + 1);
+				m_strings.emplace(str, id);
+				m_utf8.clear();
+				appendUtf8(m_utf8, str, std::char_traits<C>::length(str));
+				m_out += binarylog::tagString;
+				put(m_out, id);
+				put(m_out, static_cast<uint32_t>(m_utf8.size()));
+				m_out += m_utf8;
+				return id;
+			}
+
+			uint32_t siteIdOf(const void* site, const char* file, unsigned line, const char* function) {
+				auto found = m_sites.find(site);
+				if (found != m_sites.end())
+					return found->second;
+
+				uint32_t fileId = stringIdOf(file);
+				uint32_t functionId = stringIdOf(function);
+				uint32_t id = static_cast<uint32_t>(m_sites.size() + 1);
+				m_sites.emplace(site, id);
+				m_out += binarylog::tagSite;
+				put(m_out, id);
+				put(m_out, fileId);
+				put(m_out, static_cast<uint32_t>(line));
+				put(m_out, functionId);
+				return id;
+			}
+
+		protected:
+			std::string m_out;
+			std::string m_record;
+			std::string m_utf8;
+			size_t m_argCountPos = 0;
+			uint16_t m_argCount = 0;
+			std::unordered_map<const void*, uint32_t> m_strings;
+			std::unordered_map<const void*, uint32_t> m_sites;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
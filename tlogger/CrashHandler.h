@@ -0,0 +1,278 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include "FileWriter.h"
+#if defined __GNUC__
+	#include <execinfo.h>
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		namespace crash {
+
+			// Class Target
+			// Something the crash handler drains, every logger registers itself
+			class Target {
+			public:
+				/*
+				* Write pending records and the crash report with async-signal-safe calls
+				* @param t_report: UTF-8 lines of the crash report
+				* @param t_length: number of bytes
+				* @param t_signal: called from a signal handler, locks and the heap can not be used
+				*/
+				virtual void emergencyDrain(const char* t_report, size_t t_length, bool t_signal) noexcept = 0;
+
+			protected:
+				~Target() = default;
+			}; // end of class
+
+			// Node of the list of targets, nodes are never freed so the handler
+			// can walk the list while a logger is being destroyed
+			struct Node {
+				std::atomic<Target*> target{ nullptr };
+				Node* next = nullptr;
+			};
+
+			inline std::atomic<Node*>& targets() noexcept {
+				static std::atomic<Node*> head{ nullptr };
+				return head;
+			}
+
+			inline std::atomic<bool>& installed() noexcept {
+				static std::atomic<bool> flag{ false };
+				return flag;
+			}
+
+			// set by the first crash, a second one only ends the process
+			inline std::atomic<bool>& crashing() noexcept {
+				static std::atomic<bool> flag{ false };
+				return flag;
+			}
+
+			/*
+			* Add a target to the list drained by the crash handler
+			* @return: Node to pass to removeTarget()
+			*/
+			inline Node* addTarget(Target* t_target) {
+				Node* node = new Node();
+				node->target.store(t_target, std::memory_order_relaxed);
+				node->next = targets().load(std::memory_order_relaxed);
+				while (!targets().compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+					;
+				return node;
+			}
+
+			inline void removeTarget(Node* t_node) noexcept {
+				if (t_node != nullptr)
+					t_node->target.store(nullptr, std::memory_order_release);
+			}
+
+			// Fixed size text buffer filled without the heap
+			struct Report {
+				char data[8192];
+				size_t size = 0;
+
+				void append(const char* t_text) noexcept {
+					while (*t_text != '\0' && size < sizeof(data))
+						data[size++] = *t_text++;
+				}
+
+				void appendDecimal(unsigned long long t_value) noexcept {
+					char digits[24];
+					char* begin = formatUnsigned(digits + sizeof(digits) - 1, t_value);
+					digits[sizeof(digits) - 1] = '\0';
+					append(begin);
+				}
+
+				void appendHex(uintptr_t t_value) noexcept {
+					static const char hex[] = "0123456789abcdef";
+					char digits[2 + sizeof(uintptr_t) * 2 + 1];
+					digits[0] = '0';
+					digits[1] = 'x';
+					for (size_t i = 0; i < sizeof(uintptr_t) * 2; i++)
+						digits[2 + i] = hex[(t_value >> ((sizeof(uintptr_t) * 2 - 1 - i) * 4)) & 0xf];
+					digits[sizeof(digits) - 1] = '\0';
+					append(digits);
+				}
+			};
+
+			inline const char* signalName(int t_signal) noexcept {
+				switch (t_signal) {
+				case SIGSEGV:
+					return "SIGSEGV";
+				case SIGABRT:
+					return "SIGABRT";
+				case SIGFPE:
+					return "SIGFPE";
+				case SIGILL:
+					return "SIGILL";
+#if defined SIGBUS
+				case SIGBUS:
+					return "SIGBUS";
+#endif
+				default:
+					return "signal";
+				}
+			}
+
+			/*
+			* Append the return addresses of the calling thread, one line per frame
+			* symbols are resolved with addr2line or a debugger
+			*/
+			inline void appendBacktrace(Report& t_report, void** t_frames, int t_count) noexcept {
+				for (int i = 0; i < t_count; i++) {
+					t_report.append("  #");
+					t_report.appendDecimal(static_cast<unsigned long long>(i));
+					t_report.append(" ");
+					t_report.appendHex(reinterpret_cast<uintptr_t>(t_frames[i]));
+					t_report.append("\n");
+				}
+			}
+
+			/*
+			* Drain every logger and write the report to the standard error
+			* @param t_report: Report
+			* @param t_frames: return addresses, printed with symbols on the standard error
+			* @param t_count: number of frames
+			* @param t_signal: called from a signal handler
+			*/
+			inline void drainAll(const Report& t_report, void** t_frames, int t_count, bool t_signal) noexcept {
+				for (Node* node = targets().load(std::memory_order_acquire); node != nullptr; node = node->next) {
+					Target* target = node->target.load(std::memory_order_acquire);
+					if (target != nullptr)
+						target->emergencyDrain(t_report.data, t_report.size, t_signal);
+				}
+#if defined _MSC_VER
+				writeDescriptor(2, t_report.data, t_report.size);
+				(void)t_frames;
+				(void)t_count;
+#elif defined __GNUC__
+				// the report holds the addresses, the standard error gets the symbols too
+				size_t header = 0;
+				while (header < t_report.size && t_report.data[header] != '\n')
+					header++;
+				writeDescriptor(2, t_report.data, header < t_report.size ? header + 1 : header);
+				backtrace_symbols_fd(t_frames, t_count, 2);
+#endif
+			}
+
+			/*
+			* Handler of SIGSEGV, SIGABRT, SIGBUS and SIGFPE
+			* writes the report once and raises the signal again with the default action
+			*/
+			inline void onSignal(int t_signal) noexcept {
+				if (!crashing().exchange(true)) {
+					Report report;
+					report.append("FATAL: crash, ");
+					report.append(signalName(t_signal));
+					report.append(" (");
+					report.appendDecimal(static_cast<unsigned long long>(t_signal));
+					report.append(")\n");
+
+					void* frames[64];
+					int count = 0;
+#if defined __GNUC__
+					count = backtrace(frames, 64);
+#endif
+					appendBacktrace(report, frames, count);
+					drainAll(report, frames, count, true);
+				}
+				std::signal(t_signal, SIG_DFL);
+				std::raise(t_signal);
+			}
+
+#if defined __GNUC__
+			inline void onSignalInfo(int t_signal, siginfo_t*, void*) {
+				onSignal(t_signal);
+			}
+#else
+			inline void onSignalC(int t_signal) {
+				onSignal(t_signal);
+			}
+#endif
+
+			inline std::terminate_handler& previousTerminate() noexcept {
+				static std::terminate_handler handler = nullptr;
+				return handler;
+			}
+
+			/*
+			* std::terminate hook, writes the message of the active exception
+			* and passes on to the previous handler
+			*/
+			inline void onTerminate() {
+				if (!crashing().exchange(true)) {
+					Report report;
+					report.append("FATAL: std::terminate called");
+					if (std::exception_ptr active = std::current_exception()) {
+						try {
+							std::rethrow_exception(active);
+						}
+						catch (const std::exception& ex) {
+							report.append(", ");
+							report.append(ex.what());
+						}
+						catch (...) {
+							report.append(", unknown exception");
+						}
+					}
+					report.append("\n");
+
+					void* frames[64];
+					int count = 0;
+#if defined __GNUC__
+					count = backtrace(frames, 64);
+#endif
+					appendBacktrace(report, frames, count);
+					drainAll(report, frames, count, false);
+				}
+				if (previousTerminate() != nullptr)
+					previousTerminate()();
+				std::abort();
+			}
+
+		} // end of crash namespace
+
+		/*
+		* Install handlers of SIGSEGV, SIGABRT, SIGBUS and SIGFPE and a std::terminate hook
+		* On a crash every logger writes its buffered and queued records with async-signal-safe
+		* write() calls, then the signal and the return addresses of the crashing thread are
+		* written to the sinks and the standard error, and the signal is raised again.
+		* Call it once from the main thread, it also gives that thread an alternate signal
+		* stack so a stack overflow can be reported. Calling it again does nothing.
+		*/
+		inline void installCrashHandler() {
+
+			if (crash::installed().exchange(true))
+				return;
+#if defined __GNUC__
+			// the first call of backtrace() loads the unwinder, do it before a crash
+			void* frames[1];
+			(void)backtrace(frames, 1);
+
+			static char altStack[64 * 1024];
+			stack_t stack{};
+			stack.ss_sp = altStack;
+			stack.ss_size = sizeof(altStack);
+			(void)sigaltstack(&stack, nullptr);
+
+			struct sigaction action {};
+			action.sa_sigaction = crash::onSignalInfo;
+			action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+			sigemptyset(&action.sa_mask);
+			for (int signal : { SIGSEGV, SIGABRT, SIGBUS, SIGFPE })
+				(void)sigaction(signal, &action, nullptr);
+#else
+			for (int signal : { SIGSEGV, SIGABRT, SIGFPE })
+				(void)std::signal(signal, crash::onSignalC);
+#endif
+			crash::previousTerminate() = std::set_terminate(crash::onTerminate);
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
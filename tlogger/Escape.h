@@ -0,0 +1,158 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define TLOG_ESCAPE_SSE2 1
+	#if defined _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		namespace textescape {
+			const char hexDigits[] = "0123456789abcdef";
+
+			/*
+			* Characters which can not appear as they are in a JSON string
+			* the SIMD scan may stop at others, they are copied by the escape loop
+			*/
+			template <typename T>
+			inline bool needsEscape(T c) noexcept {
+				return c == T('"') || c == T('\\') || (c >= T(0) && c < T(0x20));
+			}
+
+#if defined TLOG_ESCAPE_SSE2
+			inline unsigned lowestBit(unsigned bits) noexcept {
+#if defined _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, bits);
+				return static_cast<unsigned>(index);
+#else
+				return static_cast<unsigned>(__builtin_ctz(bits));
+#endif
+			}
+
+			// 16 bytes per step: quote, backslash and bytes below 0x20
+			inline size_t plainLength(const char* str, size_t length) noexcept {
+				const __m128i quote = _mm_set1_epi8('"');
+				const __m128i backslash = _mm_set1_epi8('\\');
+				const __m128i control = _mm_set1_epi8(0x1F);
+				const __m128i zero = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 16 <= length; i += 16) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+					__m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+						_mm_cmpeq_epi8(_mm_subs_epu8(v, control), zero));
+					unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(hit));
+					if (bits != 0)
+						return i + lowestBit(bits);
+				}
+				for (; i < length; i++)
+					if (needsEscape(str[i]))
+						return i;
+				return length;
+			}
+
+			// 4 or 8 wide characters per step, signed compares also stop at invalid negative values
+			inline size_t plainLength(const wchar_t* str, size_t length) noexcept {
+				const size_t lanes = 16 / sizeof(wchar_t);
+				size_t i = 0;
+				for (; i + lanes <= length; i += lanes) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+					__m128i hit;
+					if (sizeof(wchar_t) == 4)
+						hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32('"')), _mm_cmpeq_epi32(v, _mm_set1_epi32('\\'))),
+							_mm_cmplt_epi32(v, _mm_set1_epi32(0x20)));
+					else
+						hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('"')), _mm_cmpeq_epi16(v, _mm_set1_epi16('\\'))),
+							_mm_cmplt_epi16(v, _mm_set1_epi16(0x20)));
+					unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(hit));
+					if (bits != 0)
+						return i + lowestBit(bits) / sizeof(wchar_t);
+				}
+				for (; i < length; i++)
+					if (needsEscape(str[i]))
+						return i;
+				return length;
+			}
+#else
+			template <typename T>
+			inline size_t plainLength(const T* str, size_t length) noexcept {
+				for (size_t i = 0; i < length; i++)
+					if (needsEscape(str[i]))
+						return i;
+				return length;
+			}
+#endif
+		}
+
+		/*
+		* Append characters escaped for a JSON string, without the quotes
+		* runs without escapes are found with SIMD where available and copied at once,
+		* characters other than quote, backslash and controls are copied as they are
+		*/
+		template <typename T>
+		inline void appendEscaped(std::basic_string<T>& out, const T* str, size_t length) {
+			for (;;) {
+				size_t plain = textescape::plainLength(str, length);
+				out.append(str, plain);
+				if (plain == length)
+					return;
+				T c = str[plain];
+				str += plain + 1;
+				length -= plain + 1;
+
+				out += T('\\');
+				switch (c) {
+				case T('"'): out += T('"'); break;
+				case T('\\'): out += T('\\'); break;
+				case T('\n'): out += T('n'); break;
+				case T('\r'): out += T('r'); break;
+				case T('\t'): out += T('t'); break;
+				case T('\b'): out += T('b'); break;
+				case T('\f'): out += T('f'); break;
+				default:
+					if (textescape::needsEscape(c)) {
+						unsigned code = static_cast<unsigned>(c);
+						out += T('u');
+						out += T('0');
+						out += T('0');
+						out += T(textescape::hexDigits[(code >> 4) & 0xF]);
+						out += T(textescape::hexDigits[code & 0xF]);
+					}
+					else {
+						out.back() = c;
+					}
+				}
+			}
+		}
+
+		/*
+		* Append a JSON string with quotes
+		*/
+		template <typename T>
+		inline void appendQuoted(std::basic_string<T>& out, const T* str, size_t length) {
+			out += T('"');
+			appendEscaped(out, str, length);
+			out += T('"');
+		}
+
+		/*
+		* Append a logfmt value, quoted only if it is empty or has spaces, '=', quotes or controls
+		*/
+		template <typename T>
+		inline void appendLogfmtValue(std::basic_string<T>& out, const T* str, size_t length) {
+			bool quote = length == 0;
+			for (size_t i = 0; i < length && !quote; i++)
+				quote = str[i] == T(' ') || str[i] == T('=') || textescape::needsEscape(str[i]);
+			if (quote)
+				appendQuoted(out, str, length);
+			else
+				out.append(str, length);
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
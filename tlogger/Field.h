@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include "TextConvert.h"
+
+namespace aricanli {
+	namespace general {
+
+		// Struct Field<C, V>
+		// Named value of a structured record, created with field()
+		// it refers to the value, use it only as an argument of log()
+		template <typename C, typename V>
+		struct Field {
+			const C* key;
+			const V& value;
+		};
+
+		/*
+		* Name a log() argument, JSON and logfmt layouts write it as its own key,
+		* the text layout writes key=value in the message
+		* Example: LOG_INFO_C("login", field("user", name), field("attempt", 3));
+		* @param key: string literal
+		* @param value: argument which log() accepts
+		*/
+		template <typename C, typename V>
+		inline Field<C, V> field(const C* key, const V& value) noexcept {
+			return Field<C, V>{ key, value };
+		}
+
+		// FieldKind enum class
+		// How a field value is written to JSON
+		enum class FieldKind : unsigned char {
+			String,
+			Number,
+			Bool
+		};
+
+		// Struct FieldSpan
+		// Position of key and value of a field in the message text of a record
+		// the field takes key=value and the separating space in the text
+		struct FieldSpan {
+			size_t keyOffset;
+			size_t keyLength;
+			size_t valueOffset;
+			size_t valueLength;
+			FieldKind kind;
+		};
+
+		template <typename A>
+		struct IsField : std::false_type {};
+
+		template <typename C, typename V>
+		struct IsField<Field<C, V>> : std::true_type {};
+
+		// true if any of the arguments is a field
+		template <typename ...A>
+		struct HasField : std::false_type {};
+
+		template <typename A, typename ...Rest>
+		struct HasField<A, Rest...> : std::integral_constant<bool, IsField<A>::value || HasField<Rest...>::value> {};
+
+		/*
+		* Kind of a value, characters are strings and non-finite floating point values
+		* are written as strings since JSON has no number for them
+		*/
+		template <typename V>
+		inline typename std::enable_if<!std::is_arithmetic<V>::value, FieldKind>::type fieldKind(const V&) noexcept {
+			return FieldKind::String;
+		}
+
+		inline FieldKind fieldKind(bool) noexcept {
+			return FieldKind::Bool;
+		}
+
+		template <typename V>
+		inline typename std::enable_if<std::is_integral<V>::value && !std::is_same<V, bool>::value, FieldKind>::type
+			fieldKind(V) noexcept {
+			return IsCharLike<V>::value ? FieldKind::String : FieldKind::Number;
+		}
+
+		template <typename V>
+		inline typename std::enable_if<std::is_floating_point<V>::value, FieldKind>::type fieldKind(V value) noexcept {
+			return value - value == 0 ? FieldKind::Number : FieldKind::String;
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,729 @@
+#pragma once
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "Sink.h"
+#include "FileWriter.h"
+#include "BinaryLog.h"
+#include "Archive.h"
+#if __cplusplus >= 201703L
+#include <filesystem>
+#else
+#if defined _MSC_VER
+	#include <direct.h>
+#elif defined __GNUC__
+	#include <sys/types.h>
+	#include <sys/stat.h>
+#endif
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		// RotationInterval enum class
+		// Time based rotation of the log file in addition to the file limit
+		enum class RotationInterval {
+			None,
+			Hourly,
+			Daily
+		};
+
+		// For PreC++17 to create a directory
+#if __cplusplus < 201703L
+
+		template <typename T>
+		static void t_mkdir(T) { }
+
+
+#if defined _MSC_VER
+		template <>
+		static void t_mkdir(std::string t_path) {
+			(void)_mkdir(t_path.c_str());
+		}
+
+		template <>
+		static void t_mkdir(std::wstring t_path) {
+			(void)_wmkdir(t_path.c_str());
+		}
+#elif defined __GNUC__
+		template <>
+		static void t_mkdir(std::string t_path) {
+			mkdir(t_path.c_str(), 0777);
+		}
+
+		template <>
+		static void t_mkdir(std::wstring t_path) {
+			std::string narrowPath;
+			appendUtf8(narrowPath, t_path.data(), t_path.size());
+			mkdir(narrowPath.c_str(), 0777);
+		}
+#endif
+
+		// For PreC++17 to rename and remove rotated files
+		inline void t_rename(const std::string& t_from, const std::string& t_to) {
+			(void)std::remove(t_to.c_str());
+			(void)std::rename(t_from.c_str(), t_to.c_str());
+		}
+
+		inline void t_remove(const std::string& t_path) {
+			(void)std::remove(t_path.c_str());
+		}
+
+#if defined _MSC_VER
+		inline void t_rename(const std::wstring& t_from, const std::wstring& t_to) {
+			(void)_wremove(t_to.c_str());
+			(void)_wrename(t_from.c_str(), t_to.c_str());
+		}
+
+		inline void t_remove(const std::wstring& t_path) {
+			(void)_wremove(t_path.c_str());
+		}
+#elif defined __GNUC__
+		inline void t_rename(const std::wstring& t_from, const std::wstring& t_to) {
+			std::string from;
+			std::string to;
+			appendUtf8(from, t_from.data(), t_from.size());
+			appendUtf8(to, t_to.data(), t_to.size());
+			t_rename(from, to);
+		}
+
+		inline void t_remove(const std::wstring& t_path) {
+			std::string path;
+			appendUtf8(path, t_path.data(), t_path.size());
+			t_remove(path);
+		}
+#endif
+
+#endif
+		// Class FileSink<T>
+		// Write records to a file with size and time based rotation
+		// through ofstream, a raw descriptor or a memory mapping, in text or binary format.
+		// Example:
+		// auto file = std::make_shared<FileSink<char>>("log/log.txt");
+		// file->setFileRotation(5, RotationInterval::Daily);
+		// Logger<char>::addSink(file);
+		template <typename T>
+		class FileSink : public Sink<T> {
+		public:
+			FileSink() = default;
+
+			/*
+			* Open given file in append mode
+			* @param t_filePath : basic_string<T>
+			*/
+			explicit FileSink(const std::basic_string<T>& t_filePath) {
+				open(t_filePath);
+			}
+
+			~FileSink() noexcept override {
+				closeFile();
+			}
+
+			/*
+			* Open the file in append mode, the file which is already open is closed first
+			* if the parent path not exist then create directory
+			* @param t_filePath : basic_string<T>
+			*/
+			void open(const std::basic_string<T>& t_filePath) {
+				m_logPath = t_filePath;
+				m_pathUtf8.clear();
+				appendChars(m_pathUtf8, m_logPath.data(), m_logPath.size());
+				openStream(m_logPath);
+			}
+
+			/*
+			* Close the file, buffered records are written first
+			*/
+			void close() noexcept {
+				closeFile();
+			}
+
+			const std::basic_string<T>& path() const noexcept {
+				return m_logPath;
+			}
+
+			/*
+			* Set file's limit (byte)
+			*/
+			void setFileLimit(unsigned long long t_fileLimit) noexcept {
+				m_maxFileSize = t_fileLimit;
+			}
+
+			/*
+			* Set rotation of the log file
+			* When the file limit is reached or the interval elapses log.txt is renamed to log.1.txt,
+			* log.1.txt to log.2.txt and so on, the oldest backup beyond t_maxBackups is removed.
+			* With 0 backups the file is truncated.
+			* @param t_maxBackups: number of rotated files kept
+			* @param t_interval: RotationInterval
+			*/
+			void setFileRotation(size_t t_maxBackups, RotationInterval t_interval = RotationInterval::None) {
+				m_maxBackups = t_maxBackups;
+				m_rotationInterval = t_interval;
+				scheduleRotation(std::chrono::system_clock::now());
+			}
+
+			/*
+			* Compress rotated files in the background, requires C++17
+			* A rotated file is renamed to log.<yyyymmdd-hhmmss>.txt and queued to a thread with the
+			* lowest priority which writes log.<yyyymmdd-hhmmss>.txt.gz (or .zst) and deletes it.
+			* The same thread keeps at most the number of backups of setFileRotation() and, if given,
+			* deletes the oldest rotated files while they exceed t_maxTotalBytes together.
+			* Without zlib or libzstd compiled in the files are only renamed and retained.
+			* @param t_compression: Compression, None turns the stage off unless a byte limit is given
+			* @param t_maxTotalBytes: size limit of the rotated files, 0 for no limit
+			*/
+			void setFileCompression(Compression t_compression, unsigned long long t_maxTotalBytes = 0) {
+				m_compression = t_compression;
+				m_maxArchiveBytes = t_maxTotalBytes;
+#if __cplusplus >= 201703L
+				if (t_compression != Compression::None || t_maxTotalBytes != 0)
+					m_archiver = FileArchiver::shared();
+				else
+					m_archiver.reset();
+#endif
+			}
+
+			/*
+			* Block until the rotated files queued so far are compressed
+			*/
+			void waitForCompression() {
+#if __cplusplus >= 201703L
+				if (m_archiver)
+					m_archiver->wait();
+#endif
+			}
+
+			/*
+			* Select how the file is written, reopen the file if it is already open
+			* FileBackend::Stream : ofstream, default
+			* FileBackend::Posix : raw descriptor in append mode with a user-space buffer
+			* FileBackend::Mapped : records are copied into a memory mapping of the file,
+			* the file is extended in chunks and trimmed when it is closed or rotated
+			* wchar_t records are written in UTF-8 by Posix and Mapped
+			* @param t_backend: FileBackend
+			*/
+			void setFileBackend(FileBackend t_backend) {
+				if (m_fileBackend == t_backend)
+					return;
+				m_fileBackend = t_backend;
+				if (!m_logPath.empty())
+					openStream(m_logPath);
+			}
+
+			/*
+			* Set when the buffer of FileBackend::Posix is written to the file
+			* @param t_policy: FlushPolicy
+			* @param t_bufferSize: bytes collected before a write, default 64 KB
+			* @param t_interval: maximum time a record waits in the buffer, default 200 ms
+			*/
+			void setFileFlushPolicy(FlushPolicy t_policy, size_t t_bufferSize = 64 * 1024,
+				std::chrono::milliseconds t_interval = std::chrono::milliseconds(200)) {
+				m_rawFile.setFlushPolicy(t_policy, t_bufferSize, t_interval);
+			}
+
+			/*
+			* Set size of the window mapped at once by FileBackend::Mapped, default 64 MB
+			* takes effect when the file is opened next time
+			* @param t_chunkSize: bytes
+			*/
+			void setFileMapChunk(size_t t_chunkSize) {
+				m_mappedFile.setChunkSize(t_chunkSize);
+			}
+
+			/*
+			* Select the layout of the file, reopen the file if it is already open
+			* FileFormat::Text : records formatted with the pattern, default
+			* FileFormat::Binary : arguments are written in a compact binary form, strings marked with
+			* literal() once per file, read it back with tools/tlog_decode
+			* A binary file is written with FileBackend::Posix unless FileBackend::Mapped is selected
+			* @param t_format: FileFormat
+			*/
+			void setFileFormat(FileFormat t_format) {
+				if (m_fileFormat == t_format)
+					return;
+				m_fileFormat = t_format;
+				if (!m_logPath.empty())
+					openStream(m_logPath);
+			}
+
+			bool textOutput() const noexcept override {
+				return m_fileFormat == FileFormat::Text;
+			}
+
+			/*
+			* Write formatted string to the file
+			* rotate the file first if the record does not fit in the file limit
+			* or the rotation interval elapsed, the limit counts the encoded bytes
+			*/
+			void write(const std::basic_string<T>& t_formatted, const LogRecord<T>& record) override {
+
+				if (m_fileFormat == FileFormat::Binary) {
+					writeBinary(record);
+					return;
+				}
+
+				size_t length = 0;
+				const char* data = encode(t_formatted, length);
+				rotateIfNeeded(record.time, length);
+				if (usesRawFile()) {
+					writeBytes(data, length);
+					m_fileSize += length;
+					this->countWritten(length);
+					countWriterErrors();
+				}
+				else {
+					m_ofs.write(data, static_cast<std::streamsize>(length));
+					m_fileSize += length;
+					if (m_ofs.fail())
+						this->countWriteErrors(1);
+					else
+						this->countWritten(length);
+				}
+			}
+
+			/*
+			* Flush the stream or the buffer of the selected backend
+			*/
+			void flush() override {
+				if (m_fileBackend == FileBackend::Mapped)
+					m_mappedFile.flush();
+				else if (usesRawFile())
+					m_rawFile.flush();
+				else
+					m_ofs.flush();
+				this->m_flushDue = m_rawFile.flushDue();
+				countWriterErrors();
+			}
+
+			/*
+			* Write a line around the buffer of the backend, binary files are not written
+			* FileBackend::Stream opens the file again with a descriptor in append mode
+			* FileBackend::Mapped writes only after emergencyFlush() trimmed the file
+			*/
+			bool writeDirect(const char* t_utf8, size_t t_length) noexcept override {
+				if (m_fileFormat == FileFormat::Binary)
+					return false;
+				if (m_fileBackend == FileBackend::Mapped)
+					return m_mappedFile.writeDirect(t_utf8, t_length);
+				if (m_fileBackend == FileBackend::Posix)
+					return m_rawFile.writeDirect(t_utf8, t_length);
+				if (m_pathUtf8.empty())
+					return false;
+#if defined _MSC_VER
+				int fd = _open(m_pathUtf8.c_str(), _O_WRONLY | _O_APPEND | _O_BINARY);
+#elif defined __GNUC__
+				int fd = ::open(m_pathUtf8.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+#endif
+				if (fd < 0)
+					return false;
+				bool written = writeDescriptor(fd, t_utf8, t_length);
+#if defined _MSC_VER
+				_close(fd);
+#elif defined __GNUC__
+				::close(fd);
+#endif
+				return written;
+			}
+
+			/*
+			* Write the buffer of the descriptor backend and trim a mapped file
+			* The buffer of ofstream is not written, basic_filebuf is not async-signal-safe,
+			* records it still holds are lost. FileBackend::Posix keeps them.
+			*/
+			void emergencyFlush() noexcept override {
+				m_rawFile.emergencyFlush();
+				m_mappedFile.emergencyFlush();
+			}
+
+		protected:
+#if __cplusplus >= 201703L
+			/*
+			* For C++17 and C++20 versions
+			* Open file in UTF-8 standart in ofstream write or append mode
+			* if the parent path not exist then create directory
+			* and take its size as the byte counter
+			* @param t_path : filesystem::path
+			*/
+			void openStream(const std::filesystem::path& t_path) {
+
+				try {
+					closeFile();
+					auto t_root = t_path.parent_path();
+
+					if (!std::filesystem::exists(t_path) && !t_root.empty()) {
+						std::filesystem::create_directories(t_root.string());
+					}
+
+					if (usesRawFile()) {
+						openRawFile(t_path.string());
+						return;
+					}
+					m_ofs.open(t_path, std::ofstream::out | std::ofstream::app);
+					m_ofs.seekp(0, std::ios_base::end);
+
+					std::error_code ec;
+					auto size = std::filesystem::file_size(t_path, ec);
+					m_fileSize = ec ? 0 : static_cast<unsigned long long>(size);
+					scheduleRotation(std::chrono::system_clock::now());
+				}
+				catch (const std::filesystem::filesystem_error& ex) {
+					std::cout << ex.what() << "\n";
+				}
+				catch (...) {
+					std::cout << "Unknown error in Logger::openFile()\n";
+				}
+			}
+
+			static void renameFile(const std::basic_string<T>& t_from, const std::basic_string<T>& t_to) {
+				std::error_code ec;
+				std::filesystem::rename(std::filesystem::path(t_from), std::filesystem::path(t_to), ec);
+			}
+
+			static void removeFile(const std::basic_string<T>& t_path) {
+				std::error_code ec;
+				std::filesystem::remove(std::filesystem::path(t_path), ec);
+			}
+#else
+			/*
+			* For C++14 and previous versions
+			* Open file in UTF-8 standart in ofstream write or append mode
+			* if the parent path not exist then create directory
+			* and take its size as the byte counter
+			* @param t_path : basic_string<T>
+			*/
+			void openStream(const std::basic_string<T>& t_path) {
+
+				closeFile();
+
+				char delim = t_path.find('/') != std::string::npos ? '/' : '\\';
+				auto ret = split(t_path, delim);
+				std::basic_string<T> path;
+				for (int i = 0; i < ret.size() - 1; i++) {
+					path += (i != 0) ? stringlit(T, "/") + ret[i] : ret[i];
+					t_mkdir(path);
+				}
+
+				if (usesRawFile()) {
+					std::string narrowPath;
+					appendUtf8(narrowPath, t_path.data(), t_path.size());
+					openRawFile(narrowPath);
+					return;
+				}
+				m_ofs.open(t_path.c_str(), std::ofstream::out | std::ofstream::app);
+				m_ofs.seekp(0, std::ios_base::end);
+
+				auto size = m_ofs.tellp();
+				m_fileSize = size < 0 ? 0 : static_cast<unsigned long long>(size);
+				scheduleRotation(std::chrono::system_clock::now());
+			}
+
+			static void renameFile(const std::basic_string<T>& t_from, const std::basic_string<T>& t_to) {
+				t_rename(t_from, t_to);
+			}
+
+			static void removeFile(const std::basic_string<T>& t_path) {
+				t_remove(t_path);
+			}
+
+			/*
+			* Divides a String into an ordered list of substrings, puts these substrings into
+			* an vector of string
+			* @param strSplit: basic_string<T>
+			* @param Delim: Template argument
+			* @return : result : vector<basic_string<T>>
+			*/
+			static std::vector<std::basic_string<T>> split(const std::basic_string<T>& strSplit, T delim) {
+				std::vector<std::basic_string<T>> result;
+				std::basic_stringstream<T> ss(strSplit);
+				std::basic_string<T> item;
+
+				while (getline(ss, item, delim)) {
+					result.push_back(item);
+				}
+				return result;
+			}
+#endif
+
+			/*
+			* Open the file with the descriptor or mapping backend
+			* @param t_path: UTF-8 path
+			*/
+			void openRawFile(const std::string& t_path) {
+
+				bool opened = m_fileBackend == FileBackend::Mapped ? m_mappedFile.open(t_path) : m_rawFile.open(t_path);
+				if (!opened)
+					std::cout << "Can not open " << t_path << " in Logger::openFile()\n";
+				m_fileSize = m_fileBackend == FileBackend::Mapped ? m_mappedFile.size() : m_rawFile.size();
+				scheduleRotation(std::chrono::system_clock::now());
+
+				if (m_fileFormat == FileFormat::Binary) {
+					m_binary.reset();
+					writeBytes(m_binary.data(), m_binary.size());
+					m_fileSize += m_binary.size();
+					m_binary.clear();
+				}
+			}
+
+			/*
+			* Binary files and the descriptor or mapping backends bypass ofstream
+			*/
+			bool usesRawFile() const noexcept {
+				return m_fileBackend != FileBackend::Stream || m_fileFormat == FileFormat::Binary;
+			}
+
+			/*
+			* Close the file of the selected backend, buffered records are written first
+			* and a mapped file is trimmed to its length
+			*/
+			void closeFile() noexcept {
+				if (m_ofs.is_open())
+					m_ofs.close();
+				m_rawFile.close();
+				m_mappedFile.close();
+				countWriterErrors();
+			}
+
+			/*
+			* Add the failed writes of the descriptor and the mapped file to metrics()
+			*/
+			void countWriterErrors() noexcept {
+				unsigned long long errors = m_rawFile.errors() + m_mappedFile.errors();
+				if (errors != m_writerErrors) {
+					this->countWriteErrors(errors - m_writerErrors);
+					m_writerErrors = errors;
+				}
+			}
+
+			/*
+			* Path of the backup with given index, log.txt -> log.<index>.txt
+			* @param index: size_t
+			* @return: basic_string<T>
+			*/
+			std::basic_string<T> backupPath(size_t index) const {
+
+				std::basic_ostringstream<T> number;
+				number << index;
+				return backupPath(number.str());
+			}
+
+			/*
+			* Path of the backup with given tag, log.txt -> log.<tag>.txt
+			* @param tag: basic_string<T>
+			* @return: basic_string<T>
+			*/
+			std::basic_string<T> backupPath(const std::basic_string<T>& tag) const {
+
+				std::basic_string<T> infix(1, '.');
+				infix += tag;
+				size_t separator = m_logPath.find_last_of(stringlit(T, "/\\"));
+				size_t dot = m_logPath.find_last_of('.');
+				if (dot == std::basic_string<T>::npos || (separator != std::basic_string<T>::npos && dot < separator))
+					return m_logPath + infix;
+				return m_logPath.substr(0, dot) + infix + m_logPath.substr(dot);
+			}
+
+#if __cplusplus >= 201703L
+			/*
+			* Path of a file handed to the archiver, log.txt -> log.<yyyymmdd-hhmmss>.txt
+			* files rotated within the same second get an increasing counter, log.<yyyymmdd-hhmmss>-1.txt
+			* @return: basic_string<T>
+			*/
+			std::basic_string<T> archivePath() {
+
+				std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+				std::tm tm{};
+#if defined _MSC_VER
+				localtime_s(&tm, &t);
+#elif defined __GNUC__
+				localtime_r(&t, &tm);
+#endif
+				char stamp[32];
+				std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+				if (m_lastArchiveStamp == stamp) {
+					m_archiveSerial++;
+				}
+				else {
+					m_lastArchiveStamp = stamp;
+					m_archiveSerial = 0;
+				}
+				// the name or its compressed file may still exist from an earlier run
+				for (unsigned long long& n = m_archiveSerial; ; n++) {
+					std::basic_ostringstream<T> tag;
+					tag << stamp;
+					if (n != 0)
+						tag << '-' << n;
+					std::basic_string<T> candidate = backupPath(tag.str());
+					std::filesystem::path file(candidate);
+					std::error_code ec;
+					if (!std::filesystem::exists(file, ec)
+						&& !std::filesystem::exists(std::filesystem::path(file) += ".gz", ec)
+						&& !std::filesystem::exists(std::filesystem::path(file) += ".zst", ec))
+						return candidate;
+				}
+			}
+#endif
+
+			/*
+			* Close the file, shift the backups and open an empty file
+			* with compression the file is handed to the archiver under a new name instead
+			*/
+			void rotateFile() {
+
+				this->countRotation();
+				closeFile();
+				if (m_maxBackups == 0) {
+					removeFile(m_logPath);
+				}
+#if __cplusplus >= 201703L
+				else if (m_archiver) {
+					// the archiver may still be compressing an older file, so the name is not reused
+					std::basic_string<T> rotated = archivePath();
+					renameFile(m_logPath, rotated);
+					m_archiver->push({ rotated, m_logPath, m_compression, m_maxBackups, m_maxArchiveBytes });
+				}
+#endif
+				else {
+					removeFile(backupPath(m_maxBackups));
+					for (size_t i = m_maxBackups - 1; i > 0; i--)
+						renameFile(backupPath(i), backupPath(i + 1));
+					renameFile(m_logPath, backupPath(1));
+				}
+				openStream(m_logPath);
+			}
+
+			/*
+			* Compute the next hour or local midnight for time based rotation
+			* @param tp: current time
+			*/
+			void scheduleRotation(const std::chrono::system_clock::time_point& tp) {
+
+				if (m_rotationInterval == RotationInterval::None) {
+					m_nextRotation = std::chrono::system_clock::time_point::max();
+					return;
+				}
+
+				std::time_t t = std::chrono::system_clock::to_time_t(tp);
+				std::tm tm{};
+#if defined _MSC_VER
+				localtime_s(&tm, &t);
+#elif defined __GNUC__
+				localtime_r(&t, &tm);
+#endif
+				tm.tm_min = 0;
+				tm.tm_sec = 0;
+				if (m_rotationInterval == RotationInterval::Hourly) {
+					tm.tm_hour += 1;
+				}
+				else {
+					tm.tm_hour = 0;
+					tm.tm_mday += 1;
+				}
+				tm.tm_isdst = -1;
+				m_nextRotation = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+			}
+
+			/*
+			* Rotate the file if the record does not fit in the file limit
+			* or the rotation interval elapsed
+			* @param tp: time of the record
+			* @param length: size of the record
+			*/
+			void rotateIfNeeded(const std::chrono::system_clock::time_point& tp, size_t length) {
+
+				if (tp >= m_nextRotation) {
+					if (m_fileSize != 0)
+						rotateFile();
+					scheduleRotation(tp);
+				}
+				else if (m_fileSize != 0 && m_fileSize + length >= m_maxFileSize) {
+					rotateFile();
+				}
+			}
+
+			/*
+			* Write a record to the binary file
+			* encoded arguments keep their types, a formatted message is written as one string
+			* @param record: LogRecord<T>
+			*/
+			void writeBinary(const LogRecord<T>& record) {
+
+				// the dictionary entries are not known yet, reserve room for a few of them
+				rotateIfNeeded(record.time, 64 + record.args.size + record.message.length() * sizeof(T));
+
+				int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count();
+				if (record.site != nullptr)
+					m_binary.beginRecord(static_cast<unsigned>(record.level), ns, record.site, record.site->file, record.site->line, record.site->function);
+				else
+					m_binary.beginRecord(static_cast<unsigned>(record.level), ns, record.argFormat);
+				if (record.argFormat != nullptr)
+					record.argFormat->toBinary(record.args.data, m_binary);
+				else if (!record.message.empty())
+					m_binary.addString(record.message.data(), record.message.length() - 1); // the decoder adds the trailing space back
+				m_binary.endRecord();
+
+				writeBytes(m_binary.data(), m_binary.size());
+				m_fileSize += m_binary.size();
+				this->countWritten(m_binary.size());
+				countWriterErrors();
+				m_binary.clear();
+			}
+
+			/*
+			* Get the bytes written for a record, wchar_t records are encoded to UTF-8 into m_utf8
+			* @param formattedStr: basic_string<T>
+			* @param length: receives the number of bytes
+			* @return: bytes of the record
+			*/
+			const char* encode(const std::basic_string<char>& formattedStr, size_t& length) noexcept {
+				length = formattedStr.length();
+				return formattedStr.data();
+			}
+
+			const char* encode(const std::basic_string<wchar_t>& formattedStr, size_t& length) {
+				m_utf8.clear();
+				appendUtf8(m_utf8, formattedStr.data(), formattedStr.length());
+				length = m_utf8.length();
+				return m_utf8.data();
+			}
+
+			void writeBytes(const char* data, size_t length) {
+				if (m_fileBackend == FileBackend::Mapped)
+					m_mappedFile.write(data, length, std::chrono::steady_clock::time_point());
+				else {
+					m_rawFile.write(data, length, std::chrono::steady_clock::now());
+					this->m_flushDue = m_rawFile.flushDue();
+				}
+			}
+
+		protected:
+			unsigned long long m_maxFileSize = 512 * 1024 * 1024; // 512 MB
+			unsigned long long m_fileSize = 0;
+			size_t m_maxBackups = 5;
+			RotationInterval m_rotationInterval = RotationInterval::None;
+			std::chrono::system_clock::time_point m_nextRotation = std::chrono::system_clock::time_point::max();
+			std::basic_string<T> m_logPath;
+			std::ofstream m_ofs;	// wchar_t records are written in UTF-8
+			FileBackend m_fileBackend = FileBackend::Stream;
+			FileFormat m_fileFormat = FileFormat::Text;
+			PosixFileWriter m_rawFile;
+			MappedFileWriter m_mappedFile;
+			BinaryLogWriter m_binary;
+			std::string m_utf8;
+			std::string m_pathUtf8;
+			unsigned long long m_writerErrors = 0;
+			Compression m_compression = Compression::None;
+			unsigned long long m_maxArchiveBytes = 0;
+#if __cplusplus >= 201703L
+			std::shared_ptr<FileArchiver> m_archiver;
+			std::string m_lastArchiveStamp;
+			unsigned long long m_archiveSerial = 0;
+#endif
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,532 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include "TextConvert.h"
+#if defined _MSC_VER
+	#include <io.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+#elif defined __GNUC__
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+	#include <sys/uio.h>
+	#include <sys/mman.h>
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		// FileBackend enum class
+		// Stream : std::ofstream, wchar_t records are encoded to UTF-8
+		// Posix : raw file descriptor opened with O_APPEND and a user-space buffer
+		// Mapped : preallocated memory mapped window of the file
+		enum class FileBackend {
+			Stream,
+			Posix,
+			Mapped
+		};
+
+		// FlushPolicy enum class
+		// Buffered : write when the buffer is full or its oldest record is older than the flush interval,
+		// the flush timer of the logger writes the buffer of an idle writer
+		// EveryRecord : write each record with one system call
+		enum class FlushPolicy {
+			Buffered,
+			EveryRecord
+		};
+
+		/*
+		* Write all bytes to a descriptor, retry on partial writes and EINTR
+		* uses only async-signal-safe calls, the crash handler writes with it
+		* @return: false if a write failed
+		*/
+		inline bool writeDescriptor(int t_fd, const char* data, size_t length) noexcept {
+			while (length != 0) {
+#if defined _MSC_VER
+				int written = _write(t_fd, data, static_cast<unsigned int>(length));
+#elif defined __GNUC__
+				ssize_t written = ::write(t_fd, data, length);
+				if (written < 0 && errno == EINTR)
+					continue;
+#endif
+				if (written <= 0)
+					return false;
+				data += written;
+				length -= static_cast<size_t>(written);
+			}
+			return true;
+		}
+
+		/*
+		* steady_clock time with the resolution of the scheduler tick, enough for the age
+		* of a buffer and much cheaper than steady_clock::now() on some virtual machines
+		*/
+		inline std::chrono::steady_clock::time_point coarseNow() noexcept {
+#if defined CLOCK_MONOTONIC_COARSE
+			timespec ts;
+			clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+			return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+#else
+			return std::chrono::steady_clock::now();
+#endif
+		}
+
+		// Class PosixFileWriter
+		// Append-only file writer on a raw descriptor.
+		// Records are collected in a user-space buffer and written with a single
+		// write() when the buffer is full or too old, a record which does not fit
+		// is written together with the buffer by writev().
+		// Example:
+		// PosixFileWriter file;
+		// file.open("log.txt");
+		// file.write(str.data(), str.size(), std::chrono::steady_clock::now());
+		// file.close();
+		class PosixFileWriter {
+		public:
+			PosixFileWriter() = default;
+			PosixFileWriter(const PosixFileWriter&) = delete;
+			PosixFileWriter& operator=(const PosixFileWriter&) = delete;
+
+			~PosixFileWriter() noexcept {
+				close();
+			}
+
+			/*
+			* Open the file in append mode, create it if it does not exist
+			* @param t_path: UTF-8 path
+			* @return: false if the file can not be opened
+			*/
+			bool open(const std::string& t_path) {
+
+				close();
+#if defined _MSC_VER
+				m_fd = _open(t_path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#elif defined __GNUC__
+				m_fd = ::open(t_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+				if (m_fd < 0)
+					return false;
+
+				m_owned = true;
+				m_size = 0;
+#if defined _MSC_VER
+				struct _stat64 st;
+				if (_fstat64(m_fd, &st) == 0)
+					m_size = static_cast<unsigned long long>(st.st_size);
+#elif defined __GNUC__
+				struct stat st;
+				if (fstat(m_fd, &st) == 0)
+					m_size = static_cast<unsigned long long>(st.st_size);
+#endif
+				m_buffer.reserve(m_bufferSize);
+				return true;
+			}
+
+			/*
+			* Write to a descriptor which is already open, like 1 or 2
+			* the descriptor is not closed by the writer
+			* @param t_fd: file descriptor
+			*/
+			void attach(int t_fd) {
+
+				close();
+				m_fd = t_fd;
+				m_owned = false;
+				m_size = 0;
+				m_buffer.reserve(m_bufferSize);
+			}
+
+			/*
+			* Write the buffer and close the descriptor
+			*/
+			void close() noexcept {
+
+				if (m_fd < 0)
+					return;
+				flush();
+				if (m_owned) {
+#if defined _MSC_VER
+					_close(m_fd);
+#elif defined __GNUC__
+					::close(m_fd);
+#endif
+				}
+				m_fd = -1;
+			}
+
+			bool isOpen() const noexcept {
+				return m_fd >= 0;
+			}
+
+			/*
+			* Size of the file including the buffered bytes
+			*/
+			unsigned long long size() const noexcept {
+				return m_size;
+			}
+
+			/*
+			* Number of writes which failed since the writer was created
+			*/
+			unsigned long long errors() const noexcept {
+				return m_errors;
+			}
+
+			/*
+			* Set flush policy, buffer size and maximum age of buffered records
+			* the age is checked by write(), the owner calls flush() at flushDue() while no record follows
+			* @param t_policy: FlushPolicy
+			* @param t_bufferSize: bytes collected before a write
+			* @param t_interval: maximum time a record waits in the buffer
+			*/
+			void setFlushPolicy(FlushPolicy t_policy, size_t t_bufferSize, std::chrono::milliseconds t_interval) {
+
+				flush();
+				m_policy = t_policy;
+				m_bufferSize = t_bufferSize;
+				m_interval = t_interval;
+				m_buffer.shrink_to_fit();
+				m_buffer.reserve(m_bufferSize);
+			}
+
+			/*
+			* Append a record
+			* @param data: bytes of the record
+			* @param length: number of bytes
+			* @param now: current time, compared with the age of the buffer
+			*/
+			void write(const char* data, size_t length, std::chrono::steady_clock::time_point now) {
+
+				if (m_fd < 0)
+					return;
+				m_size += length;
+
+				if (m_policy == FlushPolicy::EveryRecord || m_buffer.size() + length > m_bufferSize) {
+					writeAll(data, length);
+					return;
+				}
+
+				if (m_buffer.empty())
+					m_oldest = now;
+				m_buffer.insert(m_buffer.end(), data, data + length);
+				if (now - m_oldest >= m_interval)
+					flush();
+			}
+
+			/*
+			* Write buffered records to the file
+			*/
+			void flush() noexcept {
+
+				if (m_fd < 0 || m_buffer.empty())
+					return;
+				writeAll(nullptr, 0);
+			}
+
+			/*
+			* Time when the oldest buffered record is older than the flush interval
+			* @return: steady_clock::time_point, time_point::max() if the buffer is empty
+			*/
+			std::chrono::steady_clock::time_point flushDue() const noexcept {
+				if (m_buffer.empty())
+					return std::chrono::steady_clock::time_point::max();
+				return m_oldest + m_interval;
+			}
+
+			/*
+			* Write bytes to the file around the buffer with async-signal-safe calls
+			* the descriptor is in append mode, so the bytes land at the end of the file
+			* even while another thread fills the buffer
+			* @return: false if the file is not open or the write failed
+			*/
+			bool writeDirect(const char* data, size_t length) noexcept {
+				if (m_fd < 0)
+					return false;
+				return writeDescriptor(m_fd, data, length);
+			}
+
+			/*
+			* Write the buffer with async-signal-safe calls, used by the crash handler
+			* nothing is freed, the buffer keeps its capacity
+			*/
+			void emergencyFlush() noexcept {
+				if (m_fd < 0 || m_buffer.empty())
+					return;
+				writeDescriptor(m_fd, m_buffer.data(), m_buffer.size());
+				m_buffer.clear();
+			}
+
+		protected:
+			/*
+			* Write the buffer followed by given bytes, retry on partial writes and EINTR
+			*/
+			void writeAll(const char* data, size_t length) noexcept {
+#if defined _MSC_VER
+				writeRaw(m_buffer.data(), m_buffer.size());
+				writeRaw(data, length);
+#elif defined __GNUC__
+				struct iovec iov[2];
+				iov[0].iov_base = m_buffer.data();
+				iov[0].iov_len = m_buffer.size();
+				iov[1].iov_base = const_cast<char*>(data);
+				iov[1].iov_len = length;
+				struct iovec* first = iov[0].iov_len != 0 ? iov : iov + 1;
+				int count = static_cast<int>(iov + 2 - first);
+
+				while (count > 0) {
+					ssize_t written = ::writev(m_fd, first, count);
+					if (written < 0) {
+						if (errno == EINTR)
+							continue;
+						m_errors++;
+						break;
+					}
+					size_t left = static_cast<size_t>(written);
+					while (count > 0 && left >= first->iov_len) {
+						left -= first->iov_len;
+						first++;
+						count--;
+					}
+					if (count > 0) {
+						first->iov_base = static_cast<char*>(first->iov_base) + left;
+						first->iov_len -= left;
+					}
+				}
+#endif
+				m_buffer.clear();
+			}
+
+#if defined _MSC_VER
+			void writeRaw(const char* data, size_t length) noexcept {
+				while (length != 0) {
+					int written = _write(m_fd, data, static_cast<unsigned int>(length));
+					if (written <= 0) {
+						m_errors++;
+						break;
+					}
+					data += written;
+					length -= static_cast<size_t>(written);
+				}
+			}
+#endif
+
+		protected:
+			int m_fd = -1;
+			bool m_owned = true;
+			std::vector<char> m_buffer;
+			size_t m_bufferSize = 64 * 1024;
+			std::chrono::milliseconds m_interval{ 200 };
+			FlushPolicy m_policy = FlushPolicy::Buffered;
+			std::chrono::steady_clock::time_point m_oldest;
+			unsigned long long m_size = 0;
+			unsigned long long m_errors = 0;
+		}; // end of class
+
+#if defined __GNUC__
+		// Class MappedFileWriter
+		// Append-only file writer which copies records into a shared memory mapping.
+		// The file is extended and mapped in large chunks, so writing a record is a memcpy
+		// and the page cache writes the data back. Until the file is closed its size
+		// on disk is rounded up to the end of the current chunk, close() trims it
+		// to the written length.
+		// Example:
+		// MappedFileWriter file;
+		// file.open("trace.txt");
+		// file.write(str.data(), str.size(), std::chrono::steady_clock::now());
+		// file.close();
+		class MappedFileWriter {
+		public:
+			MappedFileWriter() = default;
+			MappedFileWriter(const MappedFileWriter&) = delete;
+			MappedFileWriter& operator=(const MappedFileWriter&) = delete;
+
+			~MappedFileWriter() noexcept {
+				close();
+			}
+
+			/*
+			* Open or create the file and map the chunk which contains its end
+			* @param t_path: UTF-8 path
+			* @return: false if the file can not be opened
+			*/
+			bool open(const std::string& t_path) {
+
+				close();
+				m_fd = ::open(t_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+				if (m_fd < 0)
+					return false;
+
+				struct stat st;
+				m_size = fstat(m_fd, &st) == 0 ? static_cast<unsigned long long>(st.st_size) : 0;
+				m_chunkSize = m_nextChunkSize;
+				m_trimmed = false;
+				mapWindow(m_size & ~static_cast<unsigned long long>(m_chunkSize - 1));
+				return true;
+			}
+
+			/*
+			* Unmap the window, trim the file to the written length and close it
+			*/
+			void close() noexcept {
+
+				if (m_fd < 0)
+					return;
+				unmapWindow();
+				(void)ftruncate(m_fd, static_cast<off_t>(m_size));
+				::close(m_fd);
+				m_fd = -1;
+			}
+
+			bool isOpen() const noexcept {
+				return m_fd >= 0;
+			}
+
+			unsigned long long size() const noexcept {
+				return m_size;
+			}
+
+			/*
+			* Number of writes which failed since the writer was created
+			*/
+			unsigned long long errors() const noexcept {
+				return m_errors;
+			}
+
+			/*
+			* Set the size of the mapped window, rounded up to a power of two multiple of the page size
+			* takes effect when the next file is opened
+			* @param t_chunkSize: bytes
+			*/
+			void setChunkSize(size_t t_chunkSize) noexcept {
+
+				size_t chunk = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+				while (chunk < t_chunkSize)
+					chunk <<= 1;
+				m_nextChunkSize = chunk;
+			}
+
+			/*
+			* Copy a record into the mapping, move the window forward when it is full
+			* @param data: bytes of the record
+			* @param length: number of bytes
+			*/
+			void write(const char* data, size_t length, std::chrono::steady_clock::time_point) noexcept {
+
+				if (m_fd < 0)
+					return;
+				while (length != 0) {
+					if (m_map == nullptr) {
+						// mapping failed, write through the descriptor
+						ssize_t written = pwrite(m_fd, data, length, static_cast<off_t>(m_size));
+						if (written <= 0) {
+							m_errors++;
+							return;
+						}
+						data += written;
+						length -= static_cast<size_t>(written);
+						m_size += static_cast<unsigned long long>(written);
+						continue;
+					}
+
+					size_t offset = static_cast<size_t>(m_size - m_windowStart);
+					if (offset == m_chunkSize) {
+						mapWindow(m_windowStart + m_chunkSize);
+						continue;
+					}
+					size_t count = length < m_chunkSize - offset ? length : m_chunkSize - offset;
+					std::memcpy(m_map + offset, data, count);
+					data += count;
+					length -= count;
+					m_size += count;
+				}
+			}
+
+			/*
+			* Start writeback of the mapped pages without waiting for it
+			*/
+			void flush() noexcept {
+				if (m_map != nullptr)
+					(void)msync(m_map, m_chunkSize, MS_ASYNC);
+			}
+
+			/*
+			* Trim the file to the written length, used by the crash handler
+			* the window stays mapped, other threads may still copy into it,
+			* later writes go through the descriptor, see writeDirect()
+			*/
+			void emergencyFlush() noexcept {
+				if (m_fd < 0)
+					return;
+				(void)ftruncate(m_fd, static_cast<off_t>(m_size));
+				m_trimmed = true;
+			}
+
+			/*
+			* Write bytes at the end of the file with pwrite() once emergencyFlush() trimmed it
+			* the mapping shares the pages of the file, so the bytes are seen through it too
+			* @return: false before emergencyFlush(), the mapping belongs to the writing thread
+			*/
+			bool writeDirect(const char* data, size_t length) noexcept {
+				if (m_fd < 0 || !m_trimmed)
+					return false;
+				while (length != 0) {
+					ssize_t written = pwrite(m_fd, data, length, static_cast<off_t>(m_size));
+					if (written < 0 && errno == EINTR)
+						continue;
+					if (written <= 0)
+						return false;
+					data += written;
+					length -= static_cast<size_t>(written);
+					m_size += static_cast<unsigned long long>(written);
+				}
+				return true;
+			}
+
+		protected:
+			/*
+			* Extend the file to the end of the chunk starting at t_start and map it
+			*/
+			void mapWindow(unsigned long long t_start) noexcept {
+
+				unmapWindow();
+				m_windowStart = t_start;
+				if (ftruncate(m_fd, static_cast<off_t>(t_start + m_chunkSize)) != 0)
+					return;
+				void* map = mmap(nullptr, m_chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, static_cast<off_t>(t_start));
+				if (map != MAP_FAILED)
+					m_map = static_cast<char*>(map);
+			}
+
+			void unmapWindow() noexcept {
+				if (m_map != nullptr) {
+					munmap(m_map, m_chunkSize);
+					m_map = nullptr;
+				}
+			}
+
+		protected:
+			int m_fd = -1;
+			char* m_map = nullptr;
+			size_t m_chunkSize = 64 * 1024 * 1024;		// size of the mapped window
+			size_t m_nextChunkSize = 64 * 1024 * 1024;	// used from the next open()
+			unsigned long long m_windowStart = 0;
+			unsigned long long m_size = 0;
+			bool m_trimmed = false;		// set by emergencyFlush()
+			unsigned long long m_errors = 0;
+		}; // end of class
+#else
+		// No mapping support in this build, FileBackend::Mapped writes like FileBackend::Posix
+		class MappedFileWriter : public PosixFileWriter {
+		public:
+			void setChunkSize(size_t) noexcept {}
+		}; // end of class
+#endif
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,165 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace aricanli {
+	namespace general {
+
+		// Class FlushTimer
+		// Background thread which writes the buffered records of a logger when their flush
+		// interval elapses, so a record does not wait for the next one to be written.
+		// A logger schedules itself when one of its sinks starts to buffer and is called
+		// back at the due time, it takes its own lock there and reschedules itself while
+		// records are left in a buffer. Nothing runs while no buffer is waiting.
+		// The timer is shared by the loggers which use it, the thread is started on first
+		// use and the last logger to go joins it.
+		class FlushTimer {
+		public:
+			// Something with buffered records, every logger with a buffering sink
+			class Client {
+			public:
+				/*
+				* Write the buffered records which are due, called on the thread of the timer
+				* @param t_now: steady_clock::time_point
+				* @return: time when the records still buffered are due, time_point::max() if none
+				*/
+				virtual std::chrono::steady_clock::time_point flushExpired(std::chrono::steady_clock::time_point t_now) = 0;
+
+			protected:
+				~Client() = default;
+			}; // end of class
+
+			FlushTimer() = default;
+			FlushTimer(const FlushTimer&) = delete;
+			FlushTimer& operator=(const FlushTimer&) = delete;
+			~FlushTimer() noexcept {
+				{
+					std::lock_guard<std::mutex> _lock(m_mutex);
+					m_stop = true;
+				}
+				m_wake.notify_one();
+				if (m_thread.joinable())
+					m_thread.join();
+			}
+
+			/*
+			* Get the timer shared by the loggers, create it if no logger holds it
+			* @return: shared_ptr<FlushTimer>
+			*/
+			static std::shared_ptr<FlushTimer> shared() {
+				static std::mutex mutex;
+				static std::weak_ptr<FlushTimer> current;
+				std::lock_guard<std::mutex> _lock(mutex);
+				std::shared_ptr<FlushTimer> timer = current.lock();
+				if (!timer) {
+					timer = std::make_shared<FlushTimer>();
+					current = timer;
+				}
+				return timer;
+			}
+
+			/*
+			* Call the client back at given time, an earlier time of the client is kept
+			* the thread is started on first use
+			* @param t_client: Client
+			* @param t_due: steady_clock::time_point
+			*/
+			void schedule(Client* t_client, std::chrono::steady_clock::time_point t_due) {
+				{
+					std::lock_guard<std::mutex> _lock(m_mutex);
+					insert(t_client, t_due);
+					if (!m_thread.joinable())
+						m_thread = std::thread(&FlushTimer::run, this);
+				}
+				m_wake.notify_one();
+			}
+
+			/*
+			* Forget a client, waits while it is being called back
+			* the client must not hold the lock it takes in flushExpired()
+			* @param t_client: Client
+			*/
+			void cancel(Client* t_client) {
+				std::unique_lock<std::mutex> _lock(m_mutex);
+				for (size_t i = 0; i < m_entries.size(); i++) {
+					if (m_entries[i].client == t_client) {
+						m_entries[i] = m_entries.back();
+						m_entries.pop_back();
+						break;
+					}
+				}
+				if (m_busy == t_client) {
+					m_busyCancelled = true;
+					m_idle.wait(_lock, [this, t_client] { return m_busy != t_client; });
+				}
+			}
+
+		protected:
+			struct Entry {
+				Client* client;
+				std::chrono::steady_clock::time_point due;
+			};
+
+			// called with m_mutex held
+			void insert(Client* t_client, std::chrono::steady_clock::time_point t_due) {
+				for (auto& entry : m_entries) {
+					if (entry.client == t_client) {
+						if (t_due < entry.due)
+							entry.due = t_due;
+						return;
+					}
+				}
+				m_entries.push_back({ t_client, t_due });
+			}
+
+			void run() {
+
+				std::unique_lock<std::mutex> _lock(m_mutex);
+				while (!m_stop) {
+					if (m_entries.empty()) {
+						m_wake.wait(_lock);
+						continue;
+					}
+					size_t next = 0;
+					for (size_t i = 1; i < m_entries.size(); i++) {
+						if (m_entries[i].due < m_entries[next].due)
+							next = i;
+					}
+					const auto now = std::chrono::steady_clock::now();
+					if (m_entries[next].due > now) {
+						m_wake.wait_until(_lock, m_entries[next].due);
+						continue;
+					}
+
+					Client* client = m_entries[next].client;
+					m_entries[next] = m_entries.back();
+					m_entries.pop_back();
+					m_busy = client;
+					_lock.unlock();
+					const auto due = client->flushExpired(now);
+					_lock.lock();
+					if (!m_busyCancelled && due != std::chrono::steady_clock::time_point::max())
+						insert(client, due);
+					m_busy = nullptr;
+					m_busyCancelled = false;
+					m_idle.notify_all();
+				}
+			}
+
+		protected:
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::condition_variable m_idle;
+			std::vector<Entry> m_entries;
+			std::thread m_thread;
+			Client* m_busy = nullptr;		// client called back without m_mutex
+			bool m_busyCancelled = false;
+			bool m_stop = false;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
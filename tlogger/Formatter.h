@@ -1,17 +1,63 @@
 #pragma once
 #include <sstream>
 #include <chrono>
+#include <string>
+#include <vector>
 #include <type_traits> 
+#include "Timestamp.h"
+#include "AppendStream.h"
+#include "TextConvert.h"
+#include "Field.h"
+#include "Escape.h"
 
 namespace aricanli {
 	namespace general {
 		// formatType enum class
-		// possible ways to format type : LINE , MSG , TIME , FUNC
+		// possible ways to format type : LINE , MSG , TIME , FUNC , FILE
+		// LITERAL is the text between the fields of a pattern
 		enum class formatType {
 			LINE,
 			MSG,
 			TIME,
-			FUNC
+			FUNC,
+			FILE,
+			LITERAL
+		};
+
+		// formatPattern enum class
+		// layout of a formatted record
+		// TEXT : the pattern with its literal text
+		// JSON : one object per line, fields of the pattern select the members
+		// LOGFMT : key=value pairs per line, fields of the pattern select the keys
+		enum class formatPattern {
+			TEXT,
+			JSON,
+			LOGFMT
+		};
+
+		// Struct FormatToken
+		// One instruction of a compiled format pattern
+		// offset and length select the text of LITERAL tokens in the pattern
+		struct FormatToken {
+			formatType type;
+			size_t offset;
+			size_t length;
+		};
+
+		// pointers to char or wchar_t, written as strings
+		template <typename A>
+		struct IsCharPointer : std::integral_constant<bool, std::is_pointer<A>::value &&
+			IsCharType<typename std::remove_cv<typename std::remove_pointer<A>::type>::type>::value> {};
+
+		// Struct FormatPattern<T>
+		// Pattern text, its compiled tokens and the layout
+		template <typename T>
+		struct FormatPattern {
+			std::basic_string<T> text;
+			std::vector<FormatToken> tokens;
+			formatPattern layout = formatPattern::TEXT;
+			TimePrecision precision = TimePrecision::Milliseconds;	// of %t
+			TimeZone zone = TimeZone::Local;
 		};
 
 
@@ -45,7 +91,10 @@ namespace aricanli {
 			
 		// Class Formatter
 		// Log message formatter class
-		// f :function name  / l : line / m : message / t : time 
+		// f : file name / l : line / F : function / m : message / t : ISO-8601 time / %% : percent sign
+		// f, l and F come from the call site of the LOG_* macros and stay empty for other calls
+		// The pattern is compiled once into a list of literal spans and fields,
+		// format() runs that list and appends into a single reserved string.
 		// Example : 
 		// Formatter fmt;
 		// fmt.getFormatter("%t %l %m %t")
@@ -60,10 +109,57 @@ namespace aricanli {
 			/*
 			* Get format type as basic_string<T>
 			* @param fmtStr : basic_string<T>
+			* @param layout : formatPattern, JSON and LOGFMT only use the fields of the pattern
+			*/
+			static void getFormatter(std::basic_string<T> fmt, formatPattern layout = formatPattern::TEXT) noexcept {
+
+				recompile(m_pattern, fmt, layout);
+			}
+
+			/*
+			* Get the pattern selected with getFormatter()
+			* @return: const FormatPattern<T>&
+			*/
+			static const FormatPattern<T>& pattern() noexcept {
+				return m_pattern;
+			}
+
+			/*
+			* Compile a pattern which is used beside the one of getFormatter()
+			* @param t_fmt: basic_string<T>
+			* @param t_layout: formatPattern
+			* @return: FormatPattern<T>
+			*/
+			static FormatPattern<T> compilePattern(const std::basic_string<T>& t_fmt, formatPattern t_layout = formatPattern::TEXT) {
+				FormatPattern<T> result;
+				result.text = t_fmt;
+				result.tokens = compile(result.text);
+				result.layout = t_layout;
+				return result;
+			}
+
+			/*
+			* Replace text and layout of a pattern, its precision and time zone of %t are kept
+			* @param t_pattern: FormatPattern<T>
+			* @param t_fmt: basic_string<T>
+			* @param t_layout: formatPattern
+			*/
+			static void recompile(FormatPattern<T>& t_pattern, const std::basic_string<T>& t_fmt, formatPattern t_layout) {
+				FormatPattern<T> result = compilePattern(t_fmt, t_layout);
+				result.precision = t_pattern.precision;
+				result.zone = t_pattern.zone;
+				t_pattern = std::move(result);
+			}
+
+			/*
+			* Set precision and time zone of %t in the pattern selected with getFormatter()
+			* @param t_precision: TimePrecision
+			* @param t_zone: TimeZone
 			*/
-			static void getFormatter(std::basic_string<T> fmt) noexcept {
+			static void setTimestamp(TimePrecision t_precision, TimeZone t_zone) noexcept {
 
-				m_fmt = fmt;
+				m_pattern.precision = t_precision;
+				m_pattern.zone = t_zone;
 			}
 
 
@@ -73,133 +169,393 @@ namespace aricanli {
 			*/
 			template<typename ...Args>
 			static std::basic_string<T> format( Args &&...args) {
-				std::basic_string<T> t_format = m_fmt;
-
-				// Message ->
-				size_t foundMsg = t_format.find(stringlit(T, "%m")); // char , wchar_t
-				if (foundMsg != std::string::npos) {
-					std::basic_ostringstream<T> oss;
-					using unused = int[];
-
-					(void)unused {
-						0, (oss << args << " ", 0)...
-					};
-					t_format = findAndReplace(std::move(t_format), stringlit(T, "%m"), oss.str()); // char , wchar_t
-				}
 
+				return formatRecord(formatMessage(std::forward<Args>(args)...), std::chrono::system_clock::now());
+			}
 
-				// Time ->
-				size_t foundTime = t_format.find(stringlit(T, "%t")); // char , wchar_t
-				if (foundTime != std::string::npos) {
+			/*
+			* Stream given arguments separated by a space and return as basic_string<T>
+			* the result is the text which is put in place of %m
+			* @param ...args: Variadic template arguments
+			*/
+			template<typename ...Args>
+			static std::basic_string<T> formatMessage(Args &&...args) {
+				std::basic_string<T> message;
+				appendMessage(message, std::forward<Args>(args)...);
+				return message;
+			}
 
-					std::basic_ostringstream<T> oss;
-#if __cplusplus >= 201703L
-					if constexpr (std::is_same<T, char>::value) {
-						oss << timePointAsString(std::chrono::system_clock::now()).c_str() << " ";
-					}
-#else
-					if (std::is_same<T, char>::value) {
-						oss << timePointAsString(std::chrono::system_clock::now()).c_str() << " ";
-					}
-#endif			
+			/*
+			* Append given arguments separated by a space to a string
+			* uses the AppendStream of the calling thread, nothing is allocated
+			* once the string has enough capacity
+			* @param out: basic_string<T> output buffer
+			* @param ...args: Variadic template arguments
+			*/
+			template<typename ...Args>
+			static void appendMessage(std::basic_string<T>& out, Args &&...args) {
+				auto& oss = AppendStream<T>::local().target(out);
+				using unused = int[];
 
+				(void)unused {
+					0, (appendArg(out, oss, args), out += static_cast<T>(' '), 0)...
+				};
+			}
 
-#if __cplusplus >= 201703L
-					if constexpr (std::is_same<T, wchar_t>::value) {
-						oss << timePointAsWString(std::chrono::system_clock::now()).c_str() << " ";
-					}
-#else
-					if (std::is_same<T, wchar_t>::value) {
-						oss << timePointAsWString(std::chrono::system_clock::now()).c_str() << " ";
-					}
-#endif	
+			/*
+			* Append given arguments like appendMessage() and note where the fields are
+			* @param out: basic_string<T> output buffer
+			* @param fields: positions of key and value of every field in out
+			* @param ...args: Variadic template arguments
+			*/
+			template<typename ...Args>
+			static void captureMessage(std::basic_string<T>& out, std::vector<FieldSpan>& fields, Args &&...args) {
+				auto& oss = AppendStream<T>::local().target(out);
+				using unused = int[];
 
-					t_format = findAndReplace(std::move(t_format), stringlit(T, "%t"), oss.str()); // char , wchar_t
-				}
+				(void)unused {
+					0, (appendItem(out, oss, fields, args), out += static_cast<T>(' '), 0)...
+				};
+			}
 
-				return t_format;
+			/*
+			* Append one argument, types without a direct conversion go through operator<<
+			* @param out: basic_string<T> which oss appends to
+			* @param oss: AppendStream<T> targeting out
+			* @param arg: argument
+			*/
+			template<typename A>
+			static typename std::enable_if<!std::is_arithmetic<A>::value && !std::is_array<A>::value && !IsCharPointer<A>::value>::type
+				appendArg(std::basic_string<T>&, AppendStream<T>& oss, const A& arg) {
+				oss << arg;
 			}
 
+			// integers with the digit pair table, floating point in the shortest round-trip form
+			template<typename A>
+			static typename std::enable_if<std::is_arithmetic<A>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, A arg) {
+				appendValue(out, arg);
+			}
+
+			// constant arrays with the length of the array
+			template<typename C, size_t N>
+			static typename std::enable_if<IsCharType<C>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, const C(&arg)[N]) {
+				appendChars(out, arg, literalLength<N>(arg));
+			}
+
+			// writable arrays may hold a shorter string
+			template<typename C, size_t N>
+			static typename std::enable_if<IsCharType<C>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, C(&arg)[N]) {
+				appendChars(out, arg, std::char_traits<C>::length(arg));
+			}
+
+			// taken by reference, a pointer parameter would be as good a match for the arrays above
+			template<typename A>
+			static typename std::enable_if<IsCharPointer<A>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, const A& arg) {
+				using C = typename std::remove_cv<typename std::remove_pointer<A>::type>::type;
+				appendChars(out, arg, std::char_traits<C>::length(arg));
+			}
+
+			template<typename C>
+			static typename std::enable_if<IsCharType<C>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, const std::basic_string<C>& arg) {
+				appendChars(out, arg.data(), arg.size());
+			}
+
+			template<typename C>
+			static typename std::enable_if<IsCharType<C>::value>::type
+				appendArg(std::basic_string<T>& out, AppendStream<T>&, const Literal<C>& arg) {
+				appendChars(out, arg.str, arg.length);
+			}
+
+			// fields are written as key=value in the text
+			template<typename C, typename V>
+			static void appendArg(std::basic_string<T>& out, AppendStream<T>& oss, const Field<C, V>& arg) {
+				appendChars(out, arg.key, std::char_traits<C>::length(arg.key));
+				out += static_cast<T>('=');
+				appendArg(out, oss, arg.value);
+			}
+
+			/*
+			* Write a record in the JSON or LOGFMT layout of the pattern
+			* level and message are written in place of %m, followed by the fields
+			* @param out: basic_string<T> output buffer
+			* @param t_pattern: FormatPattern<T> from compilePattern()
+			* @param t_level: name of the level
+			* @param t_message: message text as built by captureMessage() or appendMessage()
+			* @param t_length: length of the message text
+			* @param t_fields: fields of the message text
+			* @param tp: time of %t
+			* @param t_line: source line for %l, 0 if unknown
+			* @param t_file: source file for %f, nullptr if unknown
+			* @param t_function: function for %F, nullptr if unknown
+			*/
+			static void appendStructured(std::basic_string<T>& out, const FormatPattern<T>& t_pattern, const char* t_level,
+				const T* t_message, size_t t_length, const std::vector<FieldSpan>& t_fields,
+				const std::chrono::system_clock::time_point& tp, unsigned t_line = 0, const char* t_file = nullptr,
+				const char* t_function = nullptr) {
+
+				const bool json = t_pattern.layout == formatPattern::JSON;
+				bool first = true;
+				auto key = [&](const T* name, size_t length) {
+					if (json) {
+						out += static_cast<T>(first ? '{' : ',');
+						appendQuoted(out, name, length);
+						out += static_cast<T>(':');
+					}
+					else {
+						if (!first)
+							out += static_cast<T>(' ');
+						out.append(name, length);
+						out += static_cast<T>('=');
+					}
+					first = false;
+				};
+				auto text = [&](const T* value, size_t length) {
+					if (json)
+						appendQuoted(out, value, length);
+					else
+						appendLogfmtValue(out, value, length);
+				};
+				thread_local std::basic_string<T> scratch;
+
+				for (const auto& token : t_pattern.tokens) {
+					switch (token.type) {
+					case formatType::MSG: {
+						scratch.clear();
+						appendChars(scratch, t_level, std::char_traits<char>::length(t_level));
+						key(stringlit(T, "level"), 5);
+						text(scratch.data(), scratch.size());
+
+						// the message without the fields and the trailing separator
+						scratch.clear();
+						size_t begin = 0;
+						for (const auto& field : t_fields) {
+							scratch.append(t_message + begin, field.keyOffset - begin);
+							begin = field.valueOffset + field.valueLength + 1;
+						}
+						if (begin < t_length)
+							scratch.append(t_message + begin, t_length - begin);
+						if (!scratch.empty() && scratch.back() == static_cast<T>(' '))
+							scratch.pop_back();
+						key(stringlit(T, "msg"), 3);
+						text(scratch.data(), scratch.size());
+
+						for (const auto& field : t_fields) {
+							key(t_message + field.keyOffset, field.keyLength);
+							const T* value = t_message + field.valueOffset;
+							if (field.kind == FieldKind::String)
+								text(value, field.valueLength);
+							else if (field.kind == FieldKind::Bool)
+								out += field.valueLength == 1 && *value == static_cast<T>('1') ? stringlit(T, "true") : stringlit(T, "false");
+							else
+								out.append(value, field.valueLength);
+						}
+						break;
+					}
+					case formatType::TIME:
+						key(stringlit(T, "time"), 4);
+						if (json)
+							out += static_cast<T>('"');
+						appendTime(out, tp, t_pattern);
+						if (json)
+							out += static_cast<T>('"');
+						break;
+					case formatType::LINE:
+						if (t_line != 0) {
+							key(stringlit(T, "line"), 4);
+							appendLine(out, t_line);
+						}
+						break;
+					case formatType::FILE:
+						if (t_file != nullptr) {
+							scratch.clear();
+							appendChars(scratch, t_file, std::char_traits<char>::length(t_file));
+							key(stringlit(T, "file"), 4);
+							text(scratch.data(), scratch.size());
+						}
+						break;
+					case formatType::FUNC:
+						if (t_function != nullptr) {
+							scratch.clear();
+							appendChars(scratch, t_function, std::char_traits<char>::length(t_function));
+							key(stringlit(T, "func"), 4);
+							text(scratch.data(), scratch.size());
+						}
+						break;
+					case formatType::LITERAL:
+						break;
+					}
+				}
+				if (json)
+					out += first ? stringlit(T, "{}") : stringlit(T, "}");
+			}
 
-				
-		protected:
 			/*
-			* find an substr in first argument and replace with last argument
-			* param t_format: basic_string<T>
-			* param t_find: basic_string<T>
-			* param t_replace: basic_string<T>
-			* return std::move(t_format): basic_string<T>
+			* Put already formatted message and given time point into the format pattern
+			* @param t_message: basic_string<T> produced by formatMessage()
+			* @param tp: chrono::system_clock::time_point of the record
+			* @param t_line: source line for %l, 0 if unknown
+			* @param t_file: source file for %f, nullptr if unknown
+			* @param t_function: function for %F, nullptr if unknown
 			*/
-			static std::basic_string<T> findAndReplace(std::basic_string<T> t_format, const std::basic_string<T>& t_find, const std::basic_string<T>& t_replace) {
+			static std::basic_string<T> formatRecord(const std::basic_string<T>& t_message, const std::chrono::system_clock::time_point& tp,
+				unsigned t_line = 0, const char* t_file = nullptr, const char* t_function = nullptr) {
 
-				t_format.replace(t_format.find(t_find), t_find.length(), t_replace);
+				std::basic_string<T> t_format;
+				t_format.reserve(m_pattern.text.size() + t_message.size() + 32);
+				appendRecord(t_format, t_message, tp, t_line, t_file, t_function);
 				return t_format;
 			}
 
-			static std::wstring wtos(std::string& value) {
-#if defined _MSC_VER
-				const size_t cSize = value.size() + 1;
-				std::wstring wc;
-				wc.resize(cSize);
-				size_t cSize1;
-				mbstowcs_s(&cSize1, (wchar_t*)&wc[0], cSize, value.c_str(), cSize);
-				wc.pop_back();
-				return wc;
-#elif defined __GNUC__ 
-				std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> strconverter;
-				return strconverter.from_bytes(value);
-#endif
+			/*
+			* Run the compiled pattern and append the result to given string
+			* @param out: basic_string<T> output buffer
+			* @param t_message: text of %m
+			* @param tp: time of %t
+			* @param t_line: source line for %l, 0 if unknown
+			* @param t_file: source file for %f, nullptr if unknown
+			* @param t_function: function for %F, nullptr if unknown
+			*/
+			static void appendRecord(std::basic_string<T>& out, const std::basic_string<T>& t_message, const std::chrono::system_clock::time_point& tp,
+				unsigned t_line = 0, const char* t_file = nullptr, const char* t_function = nullptr) {
 
+				appendRecord(out, m_pattern, t_message, tp, t_line, t_file, t_function);
 			}
 
 			/*
-			* take time point from argument, convert to basic_string<char> format and return
-			* param : chrono::system_clock::timepoint
-			* return : basic_string<char>
+			* Run given compiled pattern and append the result to given string
+			* @param out: basic_string<T> output buffer
+			* @param t_pattern: FormatPattern<T> from compilePattern()
+			* @param t_message: text of %m
+			* @param tp: time of %t
+			* @param t_line: source line for %l, 0 if unknown
+			* @param t_file: source file for %f, nullptr if unknown
+			* @param t_function: function for %F, nullptr if unknown
 			*/
-			static std::basic_string<char> timePointAsString(const std::chrono::system_clock::time_point& tp) {
-				std::time_t t = std::chrono::system_clock::to_time_t(tp);
-				char tmBuff[30];
-#if defined _MSC_VER
-				ctime_s(tmBuff, sizeof(tmBuff), &t);
+			static void appendRecord(std::basic_string<T>& out, const FormatPattern<T>& t_pattern, const std::basic_string<T>& t_message,
+				const std::chrono::system_clock::time_point& tp, unsigned t_line = 0, const char* t_file = nullptr,
+				const char* t_function = nullptr) {
+
+				for (const auto& token : t_pattern.tokens) {
+					switch (token.type) {
+					case formatType::LITERAL:
+						out.append(t_pattern.text, token.offset, token.length);
+						break;
+					case formatType::MSG:
+						out += t_message;
+						break;
+					case formatType::TIME:
+						appendTime(out, tp, t_pattern);
+						break;
+					case formatType::LINE:
+						if (t_line != 0)
+							appendLine(out, t_line);
+						break;
+					case formatType::FILE:
+						if (t_file != nullptr)
+							for (; *t_file != '\0'; t_file++)
+								out += static_cast<T>(*t_file);
+						break;
+					case formatType::FUNC:
+						if (t_function != nullptr)
+							for (; *t_function != '\0'; t_function++)
+								out += static_cast<T>(*t_function);
+						break;
+					}
+				}
+			}
 
-#elif defined __GNUC__		
-				ctime_r(&t, tmBuff);
-#endif	
-				std::basic_string<char> ts = tmBuff;
-				ts.resize(ts.size() - 1);
-				return ts;
+		protected:
+			template<typename A>
+			static void appendItem(std::basic_string<T>& out, AppendStream<T>& oss, std::vector<FieldSpan>&, const A& arg) {
+				appendArg(out, oss, arg);
+			}
+
+			template<typename C, typename V>
+			static void appendItem(std::basic_string<T>& out, AppendStream<T>& oss, std::vector<FieldSpan>& fields, const Field<C, V>& arg) {
+				FieldSpan span;
+				span.keyOffset = out.size();
+				appendChars(out, arg.key, std::char_traits<C>::length(arg.key));
+				span.keyLength = out.size() - span.keyOffset;
+				out += static_cast<T>('=');
+				span.valueOffset = out.size();
+				appendArg(out, oss, arg.value);
+				span.valueLength = out.size() - span.valueOffset;
+				span.kind = fieldKind(arg.value);
+				fields.push_back(span);
 			}
 
 			/*
-			* take time point from argument, convert to basic_string<wchar_t> format and return
-			* param : chrono::system_clock::timepoint
-			* return : basic_string<wchar_t>
+			* Split a pattern into literal spans and fields
+			* unknown %x sequences are kept as literal text
+			* @param t_fmt: basic_string<T>
+			* @return: vector<FormatToken>
 			*/
-			static std::basic_string<wchar_t> timePointAsWString(const std::chrono::system_clock::time_point& tp) {
-				std::time_t t = std::chrono::system_clock::to_time_t(tp);
-				char tmBuff[30];
-#if defined _MSC_VER
-				ctime_s(tmBuff, sizeof(tmBuff), &t);
+			static std::vector<FormatToken> compile(const std::basic_string<T>& t_fmt) {
+				std::vector<FormatToken> tokens;
+				size_t literal = 0;
+				auto addLiteral = [&](size_t end) {
+					if (end > literal)
+						tokens.push_back({ formatType::LITERAL, literal, end - literal });
+				};
+
+				for (size_t i = 0; i + 1 < t_fmt.size(); i++) {
+					if (t_fmt[i] != '%')
+						continue;
+					formatType type;
+					switch (t_fmt[i + 1]) {
+					case 'm': type = formatType::MSG; break;
+					case 't': type = formatType::TIME; break;
+					case 'l': type = formatType::LINE; break;
+					case 'f': type = formatType::FILE; break;
+					case 'F': type = formatType::FUNC; break;
+					case '%':
+						addLiteral(i + 1);
+						literal = i + 2;
+						i++;
+						continue;
+					default:
+						continue;
+					}
+					addLiteral(i);
+					tokens.push_back({ type, i, 2 });
+					literal = i + 2;
+					i++;
+				}
+				addLiteral(t_fmt.size());
+				return tokens;
+			}
 
-#elif defined __GNUC__
+			/*
+			* Append the ISO-8601 time of %t from the timestamp cache of the calling thread
+			* in the precision and time zone of the pattern
+			*/
+			static void appendTime(std::basic_string<T>& out, const std::chrono::system_clock::time_point& tp, const FormatPattern<T>& t_pattern) {
+				thread_local TimestampCache<T> cache;
+				size_t length;
+				const T* text = cache.get(tp, t_pattern.precision, t_pattern.zone, length);
+				out.append(text, length);
+			}
 
-				ctime_r(&t, tmBuff);
-#endif				
-				std::basic_string<char> ret = tmBuff;
-				std::basic_string<wchar_t> ts = wtos(ret);
-				ts.resize(ts.size() - 1);
-				return ts;
+			/*
+			* Append decimal digits of a line number
+			*/
+			static void appendLine(std::basic_string<T>& out, unsigned t_line) {
+				appendUnsigned(out, t_line);
 			}
 
 		protected:
-			static std::basic_string<T> m_fmt;
+			static FormatPattern<T> m_pattern;
 		}; // end of class
 
 
 		// Intialize static data members
 		template<typename T>
-		std::basic_string<T> Formatter<T>::m_fmt = stringlit(T, "%m %t");
+		FormatPattern<T> Formatter<T>::m_pattern = Formatter<T>::compilePattern(stringlit(T, "%m %t"));
 
 	} // end of general namespace
 } // end of aricanli namespace
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace aricanli {
+	namespace general {
+
+		// Struct LogSite
+		// Source location of a LOG_* call, the macros create it as a static constexpr
+		// so a record only carries a pointer to it
+		// %f, %l and %F of the pattern are written from it
+		struct LogSite {
+			const char* file;		// base name of the source file
+			unsigned line;
+			const char* function;
+		};
+
+		/*
+		* Get the part of a path after the last slash or backslash
+		* evaluated at compile time when the path is a literal
+		* @param t_path: null terminated path
+		* @return: pointer into t_path
+		*/
+		constexpr const char* baseName(const char* t_path) noexcept {
+			const char* base = t_path;
+			for (const char* it = t_path; *it != '\0'; it++)
+				if (*it == '/' || *it == '\\')
+					base = it + 1;
+			return base;
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
+
+// Declare the LogSite of the current line as a static constexpr variable
+#define TLOG_LOG_SITE( name ) \
+		static constexpr aricanli::general::LogSite name{ aricanli::general::baseName(__FILE__), __LINE__, __func__ }
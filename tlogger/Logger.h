@@ -1,5 +1,8 @@
 #pragma once
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <string>
 #include <memory>
 #include <fstream>
@@ -7,90 +10,44 @@
 #include <codecvt>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include "Formatter.h"
+#include "AsyncQueue.h"
+#include "ArgEncoder.h"
+#include "Sink.h"
+#include "FileSink.h"
+#include "StdioSink.h"
+#include "NamedLogger.h"
+#include "RateLimit.h"
 #if __cplusplus >= 201703L
 #include <string_view>
-#include <filesystem>
-#else
-#if defined _MSC_VER
-	#include <direct.h>
-#elif defined __GNUC__
-	#include <sys/types.h>
-	#include <sys/stat.h>
 #endif
+
+// Numeric values of LogPriority for preprocessor checks
+#define TLOG_LEVEL_QUIET   0
+#define TLOG_LEVEL_FATAL   8
+#define TLOG_LEVEL_ERROR   16
+#define TLOG_LEVEL_WARNING 24
+#define TLOG_LEVEL_INFO    32
+#define TLOG_LEVEL_VERBOSE 40
+#define TLOG_LEVEL_DEBUG   48
+#define TLOG_LEVEL_TRACE   56
+
+// Compile time threshold of the LOG_* macros
+// calls of levels above it are removed from the build together with their arguments
+// Example: -DTLOG_ACTIVE_LEVEL=TLOG_LEVEL_INFO for release builds
+#ifndef TLOG_ACTIVE_LEVEL
+#define TLOG_ACTIVE_LEVEL TLOG_LEVEL_TRACE
 #endif
 
 namespace aricanli {
 	namespace general {
 
-		// LogPriority enum class
-		// Possible priority levels : 
-		//Quiet , Fatal , Error , Warning , Info , Verbose , Debug , Trace
-		enum class LogPriority : unsigned int {
-			Quiet = 0,
-			Fatal = 8,
-			Error = 16,
-			Warning = 24,
-			Info = 32,
-			Verbose = 40,
-			Debug = 48,
-			Trace = 56
-		};
-
-		// LogOutput enum class
-		// Possible ways to stream
-		enum class LogOutput {
-			Console,
-			File
-		};
-
-
-		// Stream wrapper class for console in char and wchar_t types
-		template <typename T>
-		class StreamWrapper {
-		public:
-			static std::basic_ostream<T>& tout;
-		};
-
-		template<>
-		std::ostream& StreamWrapper<char>::tout = std::cout;
-
-		template<>
-		std::wostream& StreamWrapper<wchar_t>::tout = std::wcout;
-
-		// For PreC++17 to create a directory 
-#if __cplusplus < 201703L
-
-		template <typename T>
-		static void t_mkdir(T) { }
-
-
-#if defined _MSC_VER
-		template <>
-		static void t_mkdir(std::string t_path) {
-			(void)_mkdir(t_path.c_str());
-		}
-
-		template <>
-		static void t_mkdir(std::wstring t_path) {
-			(void)_wmkdir(t_path.c_str());
-		}
-#elif defined __GNUC__
-		template <>
-		static void t_mkdir(std::string t_path) {
-			mkdir(t_path.c_str(), 0777);
-		}
-
-		template <>
-		static void t_mkdir(std::wstring t_path) {
-			std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> strconverter;
-			mkdir(strconverter.to_bytes(t_path).c_str(), 0777);
-		}
-#endif
-
-#endif
-		// Class Logger<> 
+		// Class Logger<>
 		// record of variadic arguments to selected stream in formatted string
+		// Records go to a list of sinks, each with its own level and pattern. setLogOutput()
+		// selects the default sink (console or file), addSink() adds more of them.
+		// The static functions use the default logger, getLogger() returns other loggers by name.
 		// Example:
 		// 	Logger<wchar_t>::setLogOutput(L"log.txt");
 		//	Logger<wchar_t>::setLogPriority(LogPriority::Debug);
@@ -102,20 +59,45 @@ namespace aricanli {
 		public:
 			Logger(const Logger&) = delete;
 			Logger& operator=(const Logger&) = delete;
-			virtual ~Logger() noexcept {
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				m_ofs.close();
-			}
+			virtual ~Logger() noexcept = default;
 
 			/*
 			* Get single instance or create new object if not created
+			* The loggers are owned by the registry, the instance only gives access to them.
 			* @return: std::shared_ptr<Logger>
 			*/
 			static std::shared_ptr<Logger> getInstance() {
 
-				if (loggerInstance == nullptr)
-					loggerInstance = std::shared_ptr<Logger<T>>(new Logger<T>{  });
-				return loggerInstance;
+				static std::shared_ptr<Logger<T>> instance(new Logger<T>{  });
+				return instance;
+			}
+
+			/*
+			* Get the logger with given name, create it on first use
+			* A new logger writes to the console with the default pattern until it is configured.
+			* The reference stays valid until the end of the program, keep it instead of
+			* looking the name up on every call. The empty name is the default logger.
+			* @param t_name: basic_string<T>
+			* @return: NamedLogger<T>&
+			*/
+			static NamedLogger<T>& getLogger(const std::basic_string<T>& t_name) {
+
+				Registry& registry = loggers();
+				std::lock_guard<std::mutex> _lock(registry.mutex);
+				auto& logger = registry.loggers[t_name];
+				if (!logger)
+					logger.reset(new NamedLogger<T>(t_name));
+				return *logger;
+			}
+
+			/*
+			* Get the logger used by the static functions and the LOG_* macros
+			* @return: NamedLogger<T>&
+			*/
+			static NamedLogger<T>& defaultLogger() {
+
+				NamedLogger<T>* logger = m_defaultLogger.load(std::memory_order_acquire);
+				return logger != nullptr ? *logger : createDefaultLogger();
 			}
 
 			/*
@@ -124,9 +106,7 @@ namespace aricanli {
 			* @param t_filePath : basic_string<T>
 			*/
 			static void setLogOutput(std::basic_string<T> t_filePath) {
-
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				m_logPath = t_filePath;
+				defaultLogger().setLogOutput(std::move(t_filePath));
 			}
 
 			/*
@@ -134,74 +114,291 @@ namespace aricanli {
 			* @param t_logPriority: enum class LogPriority
 			*/
 			static void setLogPriority(LogPriority t_logPriority) {
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				m_logPriority = t_logPriority;
+				defaultLogger().setLogPriority(t_logPriority);
+			}
+
+			/*
+			* Add a sink beside the default one
+			* records are formatted once for every distinct pattern and skipped
+			* without formatting when no sink accepts their level
+			* @param t_sink: shared_ptr<Sink<T>>
+			*/
+			static void addSink(std::shared_ptr<Sink<T>> t_sink) {
+				defaultLogger().addSink(std::move(t_sink));
+			}
+
+			/*
+			* Remove a sink, the default sink can be removed too
+			* @param t_sink: shared_ptr<Sink<T>>
+			*/
+			static void removeSink(const std::shared_ptr<Sink<T>>& t_sink) {
+				defaultLogger().removeSink(t_sink);
+			}
+
+			/*
+			* Replace all sinks including the default one
+			* setLogFormat() adds the default sink back
+			* @param t_sinks: vector<shared_ptr<Sink<T>>>
+			*/
+			static void setSinks(std::vector<std::shared_ptr<Sink<T>>> t_sinks) {
+				defaultLogger().setSinks(std::move(t_sinks));
+			}
+
+			/*
+			* Enable or disable asynchronous logging
+			* In async mode log() only pushes the record into a bounded lock-free queue
+			* and returns, a writer thread owned by the logger formats and writes it.
+			* Disabling the mode drains the queue before returning.
+			* Switch the mode while no other thread is logging.
+			* @param t_async: bool
+			* @param t_queueCapacity: maximum number of records waiting in the queue
+			*/
+			static void setAsyncMode(bool t_async, size_t t_queueCapacity = 8192) {
+				defaultLogger().setAsyncMode(t_async, t_queueCapacity);
+			}
+
+			/*
+			* Enable or disable deferred formatting of async records
+			* The calling thread only copies the arguments into a compact binary record,
+			* converting them to text is left to the writer thread.
+			* Strings marked with literal() are kept by pointer, other strings are copied.
+			* Arguments which do not fit in TLOG_RECORD_ARGS_SIZE bytes are formatted eagerly.
+			* @param t_deferred: bool
+			*/
+			static void setDeferredFormat(bool t_deferred) {
+				defaultLogger().setDeferredFormat(t_deferred);
+			}
+
+			/*
+			* Select what a log call does in async mode when the queue is full
+			* or the records waiting in it hold more memory than setQueueMemoryLimit() allows.
+			* @param t_policy: OverflowPolicy
+			* @param t_threshold: least severe level which is not dropped by OverflowPolicy::DropBelow
+			*/
+			static void setOverflowPolicy(OverflowPolicy t_policy, LogPriority t_threshold = LogPriority::Error) {
+				defaultLogger().setOverflowPolicy(t_policy, t_threshold);
+			}
+
+			/*
+			* Limit the memory held by the records waiting in the async queue
+			* @param t_bytes: 0 for no limit, default
+			*/
+			static void setQueueMemoryLimit(size_t t_bytes) {
+				defaultLogger().setQueueMemoryLimit(t_bytes);
+			}
+
+			/*
+			* Set how often a Warning record with the number of dropped records is written
+			* @param t_interval: default 1 s, 0 disables the record
+			*/
+			static void setDropReportInterval(std::chrono::milliseconds t_interval) {
+				defaultLogger().setDropReportInterval(t_interval);
+			}
+
+			/*
+			* Get the number of records of given level dropped in async mode
+			* @param messageLevel: Log Level
+			* @return: uint64_t
+			*/
+			static uint64_t droppedCount(LogPriority messageLevel) noexcept {
+				return defaultLogger().droppedCount(messageLevel);
 			}
 
-			static void log(LogPriority messageLevel) {} // For Quiet priority 
+			/*
+			* Block until every record logged before the call is written
+			* and flush the sinks
+			*/
+			static void flush() {
+				defaultLogger().flush();
+			}
+
+			/*
+			* Check the runtime level and the levels of the sinks without taking the lock
+			* LOG_* macros call it before evaluating their arguments
+			* @param messageLevel: Log Level
+			*/
+			static bool isEnabled(LogPriority messageLevel) noexcept {
+				return defaultLogger().isEnabled(messageLevel);
+			}
+
+			/*
+			* Count a log call rejected by the level check when metrics are enabled
+			* @param messageLevel: Log Level
+			*/
+			static void countFiltered(LogPriority messageLevel) {
+				defaultLogger().countFiltered(messageLevel);
+			}
+
+			static void log(LogPriority messageLevel) {} // For Quiet priority
 
 			/*
-			* Log given message with defined parameters and pass LogMessage() function
+			* Log given message with defined parameters and pass it to the sinks
 			* @param messageLevel: Log Level
 			* @param ...args: Variadic template arguments
 			*/
 			template<typename ...Args>
 			static void log(LogPriority messageLevel, Args &&...args) {
+				NamedLogger<T>& logger = defaultLogger();
+				if (logger.isEnabled(messageLevel))
+					logger.log(messageLevel, std::forward<Args>(args)...);
+				else
+					logger.countFiltered(messageLevel);
+			}
 
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				if (messageLevel <= m_logPriority) {
-					switch (messageLevel) {
-					case LogPriority::Quiet:
-						break;
-					case LogPriority::Fatal:
-						LogMessage("FATAL:", std::forward<Args>(args)...);
-
-						break;
-					case LogPriority::Error:
-						LogMessage("ERROR:", std::forward<Args>(args)...);
-
-						break;
-					case LogPriority::Warning:
-						LogMessage("WARNING:", std::forward<Args>(args)...);
+			/*
+			* Enable or disable the per thread counters of metrics(), disabled by default
+			* @param t_enabled: bool
+			*/
+			static void setMetricsEnabled(bool t_enabled) {
+				defaultLogger().setMetricsEnabled(t_enabled);
+			}
 
-						break;
-					case LogPriority::Info:
-						LogMessage("INFO:", std::forward<Args>(args)...);
+			/*
+			* Get a snapshot of the counters of the default logger and its sinks
+			* @return: LoggerMetrics
+			*/
+			static LoggerMetrics metrics() {
+				return defaultLogger().metrics();
+			}
 
-						break;
-					case LogPriority::Verbose:
-						LogMessage("VERBOSE:", std::forward<Args>(args)...);
+			/*
+			* Write the metrics periodically as an Info record or to a Prometheus text file
+			* @param t_interval: 0 disables the dump, default
+			* @param t_prometheusPath: UTF-8 path of the file, empty for a record
+			*/
+			static void setMetricsDump(std::chrono::milliseconds t_interval, const std::string& t_prometheusPath = std::string()) {
+				defaultLogger().setMetricsDump(t_interval, t_prometheusPath);
+			}
 
-						break;
-					case LogPriority::Debug:
-						LogMessage("DEBUG:", std::forward<Args>(args)...);
+			/*
+			* Let Fatal records bypass the lock of the default logger and the async queue
+			* see NamedLogger::setFatalDirectWrite()
+			* @param t_enabled: bool
+			*/
+			static void setFatalDirectWrite(bool t_enabled) {
+				defaultLogger().setFatalDirectWrite(t_enabled);
+			}
 
-						break;
-					case  LogPriority::Trace:
-						LogMessage("TRACE:", std::forward<Args>(args)...);
+			/*
+			* Keep the records which are less severe than the log priority in a ring buffer
+			* and write them before a record of the trigger level or a more severe one
+			* @param t_records: size of the ring, 0 disables it
+			* @param t_trigger: least severe level which writes the ring, LogPriority::Quiet only writes it on dumpBacktrace()
+			* @param t_captureLevel: most verbose level kept in the ring
+			*/
+			static void setBacktrace(size_t t_records, LogPriority t_trigger = LogPriority::Error, LogPriority t_captureLevel = LogPriority::Trace) {
+				defaultLogger().setBacktrace(t_records, t_trigger, t_captureLevel);
+			}
 
-						break;
-					}
-				}
+			/*
+			* Write the records of the ring buffer of setBacktrace(), oldest first, and empty it
+			*/
+			static void dumpBacktrace() {
+				defaultLogger().dumpBacktrace();
 			}
 
 			/*
 			* Get format type and pass to Formatter::getFormatter() function
-			* default as %t %m
+			* sinks of the default logger without their own pattern use it, default as %m %t
+			* formatPattern::JSON and formatPattern::LOGFMT write the fields of the pattern
+			* as keys, %m stands for the level, the message and the named arguments
+			* Example: setFormatter("%t %m %f %l", formatPattern::JSON)
+			* @param t_fmt: basic_string<T>
+			* @param t_layout: formatPattern
 			*/
-			static void setFormatter(const std::basic_string<T>& t_fmt) {
+			static void setFormatter(const std::basic_string<T>& t_fmt, formatPattern t_layout = formatPattern::TEXT) {
+
+				defaultLogger().setFormatter(t_fmt, t_layout);
+				Formatter<T>::getFormatter(t_fmt, t_layout);
+			}
 
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				fmt.getFormatter(t_fmt);
+			/*
+			* Set precision and time zone of %t for the default logger, default is milliseconds in local time
+			* loggers of getLogger() have their own, see NamedLogger::setTimestampFormat()
+			* @param t_precision: TimePrecision
+			* @param t_zone: TimeZone
+			*/
+			static void setTimestampFormat(TimePrecision t_precision, TimeZone t_zone = TimeZone::Local) {
+				defaultLogger().setTimestampFormat(t_precision, t_zone);
+				Formatter<T>::setTimestamp(t_precision, t_zone);
 			}
 
 			/*
 			* Set file's limit (byte)
 			*/
 			static void setFileLimit(unsigned long long  t_fileLimit) {
+				defaultLogger().setFileLimit(t_fileLimit);
+			}
+
+			/*
+			* Set rotation of the log file
+			* When the file limit is reached or the interval elapses log.txt is renamed to log.1.txt,
+			* log.1.txt to log.2.txt and so on, the oldest backup beyond t_maxBackups is removed.
+			* With 0 backups the file is truncated.
+			* Rotation runs on the thread which writes the record, in async mode that is the writer thread.
+			* @param t_maxBackups: number of rotated files kept
+			* @param t_interval: RotationInterval
+			*/
+			static void setFileRotation(size_t t_maxBackups, RotationInterval t_interval = RotationInterval::None) {
+				defaultLogger().setFileRotation(t_maxBackups, t_interval);
+			}
+
+			/*
+			* Compress rotated log files in a background thread and apply a retention policy, requires C++17
+			* The logging threads only queue the rotated file, they never wait for the compression.
+			* @param t_compression: Compression::Gzip or Compression::Zstd
+			* @param t_maxTotalBytes: size limit of the rotated files, 0 for no limit
+			*/
+			static void setFileCompression(Compression t_compression, unsigned long long t_maxTotalBytes = 0) {
+				defaultLogger().setFileCompression(t_compression, t_maxTotalBytes);
+			}
+
+			/*
+			* Select how the log file is written, reopen the file if it is already open
+			* FileBackend::Stream : ofstream, default
+			* FileBackend::Posix : raw descriptor in append mode with a user-space buffer
+			* FileBackend::Mapped : records are copied into a memory mapping of the file,
+			* the file is extended in chunks and trimmed when it is closed or rotated
+			* wchar_t records are written in UTF-8 by Posix and Mapped
+			* @param t_backend: FileBackend
+			*/
+			static void setFileBackend(FileBackend t_backend) {
+				defaultLogger().setFileBackend(t_backend);
+			}
+
+			/*
+			* Select the layout of the log file, reopen the file if it is already open
+			* FileFormat::Text : records formatted with the pattern of setFormatter(), default
+			* FileFormat::Binary : arguments are written in a compact binary form, strings marked with
+			* literal() once per file, read it back with tools/tlog_decode
+			* A binary file is written with FileBackend::Posix unless FileBackend::Mapped is selected,
+			* the console output is always text
+			* @param t_format: FileFormat
+			*/
+			static void setFileFormat(FileFormat t_format) {
+				defaultLogger().setFileFormat(t_format);
+			}
 
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				m_maxFileSize = t_fileLimit;
+			/*
+			* Set when the buffer of FileBackend::Posix is written to the file
+			* flush() and the destructor always write it, a shared timer thread writes the
+			* records of an idle buffer when they are older than the interval
+			* @param t_policy: FlushPolicy
+			* @param t_bufferSize: bytes collected before a write, default 64 KB
+			* @param t_interval: maximum time a record waits in the buffer, default 200 ms
+			*/
+			static void setFileFlushPolicy(FlushPolicy t_policy, size_t t_bufferSize = 64 * 1024,
+				std::chrono::milliseconds t_interval = std::chrono::milliseconds(200)) {
+				defaultLogger().setFileFlushPolicy(t_policy, t_bufferSize, t_interval);
+			}
+
+			/*
+			* Set size of the window mapped at once by FileBackend::Mapped, default 64 MB
+			* takes effect when the file is opened next time
+			* @param t_chunkSize: bytes
+			*/
+			static void setFileMapChunk(size_t t_chunkSize) {
+				defaultLogger().setFileMapChunk(t_chunkSize);
 			}
 
 			/*
@@ -210,14 +407,7 @@ namespace aricanli {
 			* if m_logPath is not empty then stream to file
 			*/
 			static void setLogFormat() {
-
-				if (m_logPath.empty()) {
-					m_logOutput = LogOutput::Console;
-				}
-				else {
-					m_logOutput = LogOutput::File;
-					openFile(m_logPath);
-				}
+				defaultLogger().setLogFormat();
 			}
 		protected:
 			/*
@@ -231,133 +421,314 @@ namespace aricanli {
 				setLogFormat();
 			}
 
-#if __cplusplus >= 201703L
-			/*
-			* For C++17 and C++20 versions
-			* Open file in UTF-8 standart in ofstream write or append mode
-			* if the parent path not exist then create directory
-			* @param t_path : filesystem::path
-			*/
-			static void openFile(std::filesystem::path t_path) {
+			// Loggers by name, created on first use and destroyed at exit
+			// after the writer threads drained their queues
+			struct Registry {
+				std::mutex mutex;
+				std::unordered_map<std::basic_string<T>, std::unique_ptr<NamedLogger<T>>> loggers;
+			};
 
-				std::lock_guard<std::mutex> _lock(m_mutex);
-				try {
-					auto t_root = t_path.parent_path();
+			// kept out of line, defaultLogger() is on the path of every LOG_* call
+			static NamedLogger<T>& createDefaultLogger() {
 
-					if (!std::filesystem::exists(t_path) && !t_root.empty()) {
-						std::filesystem::create_directories(t_root.string());
-					}
-#if defined _MSC_VER
-					m_ofs.imbue(std::locale(std::locale::empty(), new std::codecvt<wchar_t, char, mbstate_t>("en_US.utf8")));
-#elif defined __GNUC__
-					m_ofs.imbue(std::locale(std::locale(), new std::codecvt<wchar_t, char, mbstate_t>));
-#endif
-					m_ofs.open(t_path, std::ofstream::out | std::ofstream::app);
-					m_ofs.seekp(0, std::ios_base::end);
-				}
-				catch (const std::filesystem::filesystem_error& ex) {
-					std::cout << ex.what() << "\n";
-				}
-				catch (...) {
-					std::cout << "Unknown error in Logger::openFile()\n";
-				}
+				NamedLogger<T>& logger = getLogger(std::basic_string<T>());
+				m_defaultLogger.store(&logger, std::memory_order_release);
+				return logger;
 			}
-#else
-			/*
-			* For C++14 and previous versions
-			* Open file in UTF-8 standart in ofstream write or append mode
-			* if the parent path not exist then create directory
-			* @param t_path : basic_string<T>
-			*/
-			static void openFile(const std::basic_string<T>& t_path) {
-
-				std::lock_guard<std::mutex> _lock(m_mutex);
-
-				char delim = t_path.find('/') != std::string::npos ? '/' : '\\';
-				auto ret = split(t_path, delim);
-				std::basic_string<T> path;
-				for (int i = 0; i < ret.size() - 1; i++) {
-					path += (i != 0) ? stringlit(T, "/") + ret[i] : ret[i];
-					t_mkdir(path);
-				}
-#if defined _MSC_VER
-				m_ofs.imbue(std::locale(std::locale::empty(), new std::codecvt<wchar_t, char, mbstate_t>("en_US.utf8")));
-#elif defined __GNUC__
-				m_ofs.imbue(std::locale(std::locale(), new std::codecvt<wchar_t, char, mbstate_t>));
-#endif
-				m_ofs.open(t_path.c_str(), std::ofstream::out | std::ofstream::app);
-				m_ofs.seekp(0, std::ios_base::end);
-			}
-#endif
-			/*
-			* Pass argumants to set Formatter::format() and take back as formatted string
-			* and write the string to choosen stream in constructor
-			* @param ...args: Variadic template arguments
-			*/
-			template <typename ...Args>
-			static void LogMessage(Args &&...args) {
-
-				auto formattedStr = fmt.format(std::forward<Args>(args)...);
-
-				formattedStr += '\n';
-				if (m_logOutput == LogOutput::File) {
-					if ((static_cast<unsigned long long>(m_ofs.tellp()) + formattedStr.length()) >= m_maxFileSize) {
-						m_ofs.close();
-						m_ofs.open(m_logPath, std::ios::out | std::ios::trunc);
-					}
-					m_ofs << formattedStr.c_str();
-				}
-				if (m_logOutput == LogOutput::Console)
-					StreamWrapper<T>::tout << formattedStr.c_str();
 
+			static Registry& loggers() {
+				static Registry registry;
+				return registry;
 			}
 
-			/*
-			* Divides a String into an ordered list of substrings, puts these substrings into
-			* an vector of string
-			* @param strSplit: basic_string<T>
-			* @param Delim: Template argument
-			* @return : result : vector<basic_string<T>>
-			*/
-			static std::vector<std::basic_string<T>> split(const std::basic_string<T>& strSplit, T delim) {
-				std::vector<std::basic_string<T>> result;
-				std::basic_stringstream<T> ss(strSplit);
-				std::basic_string<T> item;
+			// constant initialized, usable from other static initializers
+			static std::atomic<NamedLogger<T>*> m_defaultLogger;
+		}; // end of class
+
+		/*
+		* Get a char logger by name, see Logger<T>::getLogger()
+		* @param t_name: string
+		* @return: NamedLogger<char>&
+		*/
+		inline NamedLogger<char>& getLogger(const std::string& t_name) {
+			return Logger<char>::getLogger(t_name);
+		}
 
-				while (getline(ss, item, delim)) {
-					result.push_back(item);
-				}
-				return result;
-			}
-		protected:
-			static std::mutex m_mutex;
-			static Formatter<T> fmt;
-			static unsigned long long m_maxFileSize;
-			static std::basic_string<T> m_logPath;
-			static std::basic_ofstream<T> m_ofs;
-			static std::shared_ptr<Logger<T>> loggerInstance;
-			static LogPriority m_logPriority;
-			static LogOutput m_logOutput;
-			;
-		}; // end of class 
+		/*
+		* Get a wchar_t logger by name, see Logger<T>::getLogger()
+		* @param t_name: wstring
+		* @return: NamedLogger<wchar_t>&
+		*/
+		inline NamedLogger<wchar_t>& getLoggerW(const std::wstring& t_name) {
+			return Logger<wchar_t>::getLogger(t_name);
+		}
 
 		// Macro definitions for Logger::log() 
 #define LOG_QUIET()
 #define LOG_SET_FORMAT_C( formatter )  aricanli::general::Logger<char>::setFormatter(formatter)
 #define LOG_SET_FILE_LIMIT_C( fileLimit) aricanli::general::Logger<char>::setFileLimit(fileLimit)
+#define LOG_SET_FILE_ROTATION_C( maxBackups, interval ) aricanli::general::Logger<char>::setFileRotation(maxBackups, interval)
 #define LOG_SET_OUTPUT_C( path) \
 		   aricanli::general::Logger<char>::setLogOutput(path); \
 			aricanli::general::Logger<char>::setLogFormat()
 #define LOG_SET_PRIORITY_C( severity ) \
 		 aricanli::general::Logger<char>::setLogPriority( static_cast<aricanli::general::LogPriority>(severity))
 
-#define LOG_FATAL_C( ... )   aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Fatal, __VA_ARGS__ )
-#define LOG_ERROR_C(  ... )  aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Error, __VA_ARGS__ )
-#define LOG_WARNING_C( ... ) aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Warning, __VA_ARGS__ )
-#define LOG_INFO_C( ...)     aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Info, __VA_ARGS__ )
-#define LOG_VERBOSE_C( ... ) aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Verbose, __VA_ARGS__ )
-#define LOG_DEBUG_C( ... )   aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Debug, __VA_ARGS__ )
-#define LOG_TRACE_C( ... )   aricanli::general::Logger<char>::log(aricanli::general::LogPriority::Trace, __VA_ARGS__ )
+// Arguments are only evaluated if the level passes the runtime check
+// the logger expression is evaluated once, the record points to a static LogSite of the call
+#define TLOG_LOGGER_IF_ENABLED( logger, level, ... ) \
+		do { \
+			TLOG_LOG_SITE(tlog_callsite_); \
+			auto& tlog_logger_ = (logger); \
+			if (tlog_logger_.isEnabled(level)) \
+				tlog_logger_.logAt(&tlog_callsite_, level, __VA_ARGS__ ); \
+			else \
+				tlog_logger_.countFiltered(level); \
+		} while (0)
+#define TLOG_LOG_IF_ENABLED( type, level, ... ) \
+		TLOG_LOGGER_IF_ENABLED(aricanli::general::Logger<type>::defaultLogger(), level, __VA_ARGS__ )
+#define TLOG_LOG_DISABLED() do { } while (0)
+
+// Call site limited variants, the state is a static local of the expansion
+// and is checked after the level, before the arguments are evaluated
+#define TLOG_LOGGER_LIMITED( logger, level, perSecond, ... ) \
+		do { \
+			static aricanli::general::RateLimiter tlog_site_; \
+			TLOG_LOG_SITE(tlog_callsite_); \
+			auto& tlog_logger_ = (logger); \
+			if (!tlog_logger_.isEnabled(level)) \
+				tlog_logger_.countFiltered(level); \
+			else if (tlog_site_.acquire(perSecond)) { \
+				if (uint64_t tlog_count_ = tlog_site_.takeSuppressed()) \
+					aricanli::general::logSuppressed(tlog_logger_, &tlog_callsite_, level, tlog_count_); \
+				tlog_logger_.logAt(&tlog_callsite_, level, __VA_ARGS__ ); \
+			} \
+		} while (0)
+#define TLOG_LOGGER_SAMPLED( logger, level, every, ... ) \
+		do { \
+			static aricanli::general::LogSampler tlog_site_; \
+			TLOG_LOG_SITE(tlog_callsite_); \
+			auto& tlog_logger_ = (logger); \
+			if (!tlog_logger_.isEnabled(level)) \
+				tlog_logger_.countFiltered(level); \
+			else if (tlog_site_.sample(every)) \
+				tlog_logger_.logAt(&tlog_callsite_, level, __VA_ARGS__ ); \
+		} while (0)
+#define TLOG_LOGGER_DEDUP( logger, level, windowMs, ... ) \
+		do { \
+			static aricanli::general::RepeatFilter tlog_site_; \
+			TLOG_LOG_SITE(tlog_callsite_); \
+			auto& tlog_logger_ = (logger); \
+			if (!tlog_logger_.isEnabled(level)) \
+				tlog_logger_.countFiltered(level); \
+			else if (tlog_site_.pass(windowMs)) { \
+				if (uint64_t tlog_count_ = tlog_site_.takeRepeated()) \
+					aricanli::general::logRepeated(tlog_logger_, &tlog_callsite_, level, tlog_count_); \
+				tlog_logger_.logAt(&tlog_callsite_, level, __VA_ARGS__ ); \
+			} \
+		} while (0)
+#define TLOG_DEFAULT_LOGGER( type ) aricanli::general::Logger<type>::defaultLogger()
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_FATAL
+#define LOG_FATAL_C( ... )   TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Fatal, __VA_ARGS__ )
+#define LOG_FATAL_W( ... )   TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Fatal, __VA_ARGS__ )
+#define LOG_FATAL_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Fatal, __VA_ARGS__ )
+#define LOG_FATAL_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Fatal, perSecond, __VA_ARGS__ )
+#define LOG_FATAL_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Fatal, perSecond, __VA_ARGS__ )
+#define LOG_FATAL_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Fatal, perSecond, __VA_ARGS__ )
+#define LOG_FATAL_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Fatal, n, __VA_ARGS__ )
+#define LOG_FATAL_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Fatal, n, __VA_ARGS__ )
+#define LOG_FATAL_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Fatal, n, __VA_ARGS__ )
+#define LOG_FATAL_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Fatal, windowMs, __VA_ARGS__ )
+#define LOG_FATAL_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Fatal, windowMs, __VA_ARGS__ )
+#define LOG_FATAL_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Fatal, windowMs, __VA_ARGS__ )
+#else
+#define LOG_FATAL_C( ... )   TLOG_LOG_DISABLED()
+#define LOG_FATAL_W( ... )   TLOG_LOG_DISABLED()
+#define LOG_FATAL_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_FATAL_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_ERROR
+#define LOG_ERROR_C( ... )   TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Error, __VA_ARGS__ )
+#define LOG_ERROR_W( ... )   TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Error, __VA_ARGS__ )
+#define LOG_ERROR_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Error, __VA_ARGS__ )
+#define LOG_ERROR_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Error, perSecond, __VA_ARGS__ )
+#define LOG_ERROR_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Error, perSecond, __VA_ARGS__ )
+#define LOG_ERROR_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Error, perSecond, __VA_ARGS__ )
+#define LOG_ERROR_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Error, n, __VA_ARGS__ )
+#define LOG_ERROR_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Error, n, __VA_ARGS__ )
+#define LOG_ERROR_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Error, n, __VA_ARGS__ )
+#define LOG_ERROR_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Error, windowMs, __VA_ARGS__ )
+#define LOG_ERROR_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Error, windowMs, __VA_ARGS__ )
+#define LOG_ERROR_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Error, windowMs, __VA_ARGS__ )
+#else
+#define LOG_ERROR_C( ... )   TLOG_LOG_DISABLED()
+#define LOG_ERROR_W( ... )   TLOG_LOG_DISABLED()
+#define LOG_ERROR_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_ERROR_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_WARNING
+#define LOG_WARNING_C( ... ) TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Warning, __VA_ARGS__ )
+#define LOG_WARNING_W( ... ) TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Warning, __VA_ARGS__ )
+#define LOG_WARNING_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Warning, __VA_ARGS__ )
+#define LOG_WARNING_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Warning, perSecond, __VA_ARGS__ )
+#define LOG_WARNING_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Warning, perSecond, __VA_ARGS__ )
+#define LOG_WARNING_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Warning, perSecond, __VA_ARGS__ )
+#define LOG_WARNING_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Warning, n, __VA_ARGS__ )
+#define LOG_WARNING_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Warning, n, __VA_ARGS__ )
+#define LOG_WARNING_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Warning, n, __VA_ARGS__ )
+#define LOG_WARNING_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Warning, windowMs, __VA_ARGS__ )
+#define LOG_WARNING_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Warning, windowMs, __VA_ARGS__ )
+#define LOG_WARNING_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Warning, windowMs, __VA_ARGS__ )
+#else
+#define LOG_WARNING_C( ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_W( ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_WARNING_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_INFO
+#define LOG_INFO_C( ... )    TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Info, __VA_ARGS__ )
+#define LOG_INFO_W( ... )    TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Info, __VA_ARGS__ )
+#define LOG_INFO_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Info, __VA_ARGS__ )
+#define LOG_INFO_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Info, perSecond, __VA_ARGS__ )
+#define LOG_INFO_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Info, perSecond, __VA_ARGS__ )
+#define LOG_INFO_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Info, perSecond, __VA_ARGS__ )
+#define LOG_INFO_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Info, n, __VA_ARGS__ )
+#define LOG_INFO_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Info, n, __VA_ARGS__ )
+#define LOG_INFO_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Info, n, __VA_ARGS__ )
+#define LOG_INFO_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Info, windowMs, __VA_ARGS__ )
+#define LOG_INFO_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Info, windowMs, __VA_ARGS__ )
+#define LOG_INFO_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Info, windowMs, __VA_ARGS__ )
+#else
+#define LOG_INFO_C( ... )    TLOG_LOG_DISABLED()
+#define LOG_INFO_W( ... )    TLOG_LOG_DISABLED()
+#define LOG_INFO_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_INFO_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_VERBOSE
+#define LOG_VERBOSE_C( ... ) TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Verbose, __VA_ARGS__ )
+#define LOG_VERBOSE_W( ... ) TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Verbose, __VA_ARGS__ )
+#define LOG_VERBOSE_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Verbose, __VA_ARGS__ )
+#define LOG_VERBOSE_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Verbose, perSecond, __VA_ARGS__ )
+#define LOG_VERBOSE_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Verbose, perSecond, __VA_ARGS__ )
+#define LOG_VERBOSE_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Verbose, perSecond, __VA_ARGS__ )
+#define LOG_VERBOSE_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Verbose, n, __VA_ARGS__ )
+#define LOG_VERBOSE_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Verbose, n, __VA_ARGS__ )
+#define LOG_VERBOSE_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Verbose, n, __VA_ARGS__ )
+#define LOG_VERBOSE_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Verbose, windowMs, __VA_ARGS__ )
+#define LOG_VERBOSE_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Verbose, windowMs, __VA_ARGS__ )
+#define LOG_VERBOSE_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Verbose, windowMs, __VA_ARGS__ )
+#else
+#define LOG_VERBOSE_C( ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_W( ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_VERBOSE_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_DEBUG
+#define LOG_DEBUG_C( ... )   TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Debug, __VA_ARGS__ )
+#define LOG_DEBUG_W( ... )   TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Debug, __VA_ARGS__ )
+#define LOG_DEBUG_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Debug, __VA_ARGS__ )
+#define LOG_DEBUG_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Debug, perSecond, __VA_ARGS__ )
+#define LOG_DEBUG_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Debug, perSecond, __VA_ARGS__ )
+#define LOG_DEBUG_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Debug, perSecond, __VA_ARGS__ )
+#define LOG_DEBUG_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Debug, n, __VA_ARGS__ )
+#define LOG_DEBUG_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Debug, n, __VA_ARGS__ )
+#define LOG_DEBUG_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Debug, n, __VA_ARGS__ )
+#define LOG_DEBUG_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Debug, windowMs, __VA_ARGS__ )
+#define LOG_DEBUG_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Debug, windowMs, __VA_ARGS__ )
+#define LOG_DEBUG_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Debug, windowMs, __VA_ARGS__ )
+#else
+#define LOG_DEBUG_C( ... )   TLOG_LOG_DISABLED()
+#define LOG_DEBUG_W( ... )   TLOG_LOG_DISABLED()
+#define LOG_DEBUG_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_DEBUG_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#if TLOG_ACTIVE_LEVEL >= TLOG_LEVEL_TRACE
+#define LOG_TRACE_C( ... )   TLOG_LOG_IF_ENABLED(char, aricanli::general::LogPriority::Trace, __VA_ARGS__ )
+#define LOG_TRACE_W( ... )   TLOG_LOG_IF_ENABLED(wchar_t, aricanli::general::LogPriority::Trace, __VA_ARGS__ )
+#define LOG_TRACE_L( logger, ... ) TLOG_LOGGER_IF_ENABLED(logger, aricanli::general::LogPriority::Trace, __VA_ARGS__ )
+#define LOG_TRACE_LIMIT_C( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Trace, perSecond, __VA_ARGS__ )
+#define LOG_TRACE_LIMIT_W( perSecond, ... ) TLOG_LOGGER_LIMITED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Trace, perSecond, __VA_ARGS__ )
+#define LOG_TRACE_LIMIT_L( logger, perSecond, ... ) TLOG_LOGGER_LIMITED(logger, aricanli::general::LogPriority::Trace, perSecond, __VA_ARGS__ )
+#define LOG_TRACE_EVERY_C( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Trace, n, __VA_ARGS__ )
+#define LOG_TRACE_EVERY_W( n, ... ) TLOG_LOGGER_SAMPLED(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Trace, n, __VA_ARGS__ )
+#define LOG_TRACE_EVERY_L( logger, n, ... ) TLOG_LOGGER_SAMPLED(logger, aricanli::general::LogPriority::Trace, n, __VA_ARGS__ )
+#define LOG_TRACE_DEDUP_C( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(char), aricanli::general::LogPriority::Trace, windowMs, __VA_ARGS__ )
+#define LOG_TRACE_DEDUP_W( windowMs, ... ) TLOG_LOGGER_DEDUP(TLOG_DEFAULT_LOGGER(wchar_t), aricanli::general::LogPriority::Trace, windowMs, __VA_ARGS__ )
+#define LOG_TRACE_DEDUP_L( logger, windowMs, ... ) TLOG_LOGGER_DEDUP(logger, aricanli::general::LogPriority::Trace, windowMs, __VA_ARGS__ )
+#else
+#define LOG_TRACE_C( ... )   TLOG_LOG_DISABLED()
+#define LOG_TRACE_W( ... )   TLOG_LOG_DISABLED()
+#define LOG_TRACE_L( logger, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_LIMIT_C( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_LIMIT_W( perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_LIMIT_L( logger, perSecond, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_EVERY_C( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_EVERY_W( n, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_EVERY_L( logger, n, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_DEDUP_C( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_DEDUP_W( windowMs, ... ) TLOG_LOG_DISABLED()
+#define LOG_TRACE_DEDUP_L( logger, windowMs, ... ) TLOG_LOG_DISABLED()
+#endif
+
+#define LOG_SET_ASYNC_C( async ) aricanli::general::Logger<char>::setAsyncMode(async)
+#define LOG_SET_DEFERRED_C( deferred ) aricanli::general::Logger<char>::setDeferredFormat(deferred)
+#define LOG_FLUSH_C()        aricanli::general::Logger<char>::flush()
+#define LOG_SET_FILE_FORMAT_C( format ) aricanli::general::Logger<char>::setFileFormat(format)
 
 
 #define LOG_SET_FORMAT_W( formatter ) aricanli::general::Logger<wchar_t>::setFormatter(formatter)
@@ -366,40 +737,24 @@ namespace aricanli {
 		aricanli::general::Logger<wchar_t>::setLogFormat()
 #define LOG_SET_FILE_LIMIT_W( fileLimit) \
 		aricanli::general::Logger<wchar_t>::setFileLimit(fileLimit)
+#define LOG_SET_FILE_ROTATION_W( maxBackups, interval ) \
+		aricanli::general::Logger<wchar_t>::setFileRotation(maxBackups, interval)
 
 #define LOG_SET_PRIORITY_W(severity)\
 	 aricanli::general::Logger<wchar_t>::setLogPriority( static_cast<aricanli::general::LogPriority>(severity))
 
-#define LOG_FATAL_W( ... )   aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Fatal, __VA_ARGS__ )
-#define LOG_ERROR_W( ... )   aricanli::general::Logger<wchar_t>::log( aricanli::general::LogPriority::Error, __VA_ARGS__ )
-#define LOG_WARNING_W( ... ) aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Warning, __VA_ARGS__ )
-#define LOG_INFO_W( ...)     aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Info, __VA_ARGS__ )
-#define LOG_VERBOSE_W( ... ) aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Verbose, __VA_ARGS__ )
-#define LOG_DEBUG_W( ... )   aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Debug, __VA_ARGS__ )
-#define LOG_TRACE_W( ... )   aricanli::general::Logger<wchar_t>::log(aricanli::general::LogPriority::Trace, __VA_ARGS__ )
+#define LOG_SET_ASYNC_W( async ) aricanli::general::Logger<wchar_t>::setAsyncMode(async)
+#define LOG_SET_DEFERRED_W( deferred ) aricanli::general::Logger<wchar_t>::setDeferredFormat(deferred)
+#define LOG_FLUSH_W()        aricanli::general::Logger<wchar_t>::flush()
+#define LOG_SET_FILE_FORMAT_W( format ) aricanli::general::Logger<wchar_t>::setFileFormat(format)
 
 
 		// Intialize static data members
 		template<typename T>
-		std::mutex Logger<T>::m_mutex;
-		template<typename T>
-		std::basic_ofstream<T> Logger<T>::m_ofs;
-		template<typename T>
-		unsigned long long Logger<T>::m_maxFileSize = 512 *1024 * 1024; // 512 MB
-		template<typename T>
-		LogPriority Logger<T>::m_logPriority = LogPriority::Trace;
-		template<typename T>
-		LogOutput Logger<T>::m_logOutput = LogOutput::Console;
-		template<typename T>
-		std::basic_string<T> Logger<T>::m_logPath;
-		template<typename T>
-		std::shared_ptr<Logger<T>> Logger<T>::loggerInstance = nullptr;
-		template <typename T>
-		Formatter<T> Logger<T>::fmt;
+		std::atomic<NamedLogger<T>*> Logger<T>::m_defaultLogger{ nullptr };
 
 		// template alias for Logger class
 		using LoggerW = Logger<wchar_t>;
 
 	} // end of general namespace
 } // end of aricanli namespace
- 
\ No newline at end of file
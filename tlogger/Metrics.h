@@ -0,0 +1,232 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "TextConvert.h"
+#include "Sink.h"
+
+namespace aricanli {
+	namespace general {
+
+		namespace metrics {
+			// Number of LogPriority values, counters are indexed by levelIndex()
+			constexpr size_t levelCount = 8;
+
+			inline size_t levelIndex(LogPriority messageLevel) noexcept {
+				return (static_cast<size_t>(messageLevel) / 8) & (levelCount - 1);
+			}
+
+			inline LogPriority levelAt(size_t t_index) noexcept {
+				return static_cast<LogPriority>(t_index * 8);
+			}
+
+			/*
+			* Add to a counter which only one thread writes, no read-modify-write is needed
+			*/
+			inline void bump(std::atomic<uint64_t>& t_counter, uint64_t t_value) noexcept {
+				t_counter.store(t_counter.load(std::memory_order_relaxed) + t_value, std::memory_order_relaxed);
+			}
+
+			inline uint64_t elapsedNs(std::chrono::steady_clock::time_point t_start) noexcept {
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - t_start).count());
+			}
+		} // end of metrics namespace
+
+		// Struct LoggerMetrics
+		// Snapshot of the counters of a logger returned by NamedLogger::metrics()
+		// per level arrays are indexed by metrics::levelIndex(), times are in nanoseconds
+		struct LoggerMetrics {
+			uint64_t accepted[metrics::levelCount] = {};	// records which passed the level check
+			uint64_t filtered[metrics::levelCount] = {};	// calls rejected by the level check
+			uint64_t dropped[metrics::levelCount] = {};		// records dropped by the overflow policy
+			uint64_t formatNs = 0;		// capturing the arguments and formatting the text
+			uint64_t writeNs = 0;		// Sink::write() calls
+			uint64_t lockWaitNs = 0;	// waiting for the lock of the logger
+			std::vector<SinkMetrics> sinks;	// in the order of the sinks of the logger
+
+			static uint64_t total(const uint64_t (&t_counts)[metrics::levelCount]) noexcept {
+				uint64_t sum = 0;
+				for (uint64_t count : t_counts)
+					sum += count;
+				return sum;
+			}
+		};
+
+		// Class MetricsCounters
+		// Counters of one logger split in a block per thread, so a log call only writes
+		// to a cache line of its own thread. metrics() sums the blocks on read.
+		// Blocks are created on the first call of a thread and kept until the logger is destroyed,
+		// the counts of finished threads stay in the sums.
+		class MetricsCounters {
+		public:
+			struct Block {
+				std::atomic<uint64_t> accepted[metrics::levelCount];
+				std::atomic<uint64_t> filtered[metrics::levelCount];
+				std::atomic<uint64_t> formatNs{ 0 };
+				std::atomic<uint64_t> writeNs{ 0 };
+				std::atomic<uint64_t> lockWaitNs{ 0 };
+				Block* next = nullptr;
+
+				Block() noexcept {
+					for (size_t i = 0; i < metrics::levelCount; i++) {
+						accepted[i].store(0, std::memory_order_relaxed);
+						filtered[i].store(0, std::memory_order_relaxed);
+					}
+				}
+			};
+
+			MetricsCounters() = default;
+			MetricsCounters(const MetricsCounters&) = delete;
+			MetricsCounters& operator=(const MetricsCounters&) = delete;
+			~MetricsCounters() noexcept {
+				Block* block = m_head.load(std::memory_order_acquire);
+				while (block != nullptr) {
+					Block* next = block->next;
+					delete block;
+					block = next;
+				}
+			}
+
+			/*
+			* Get the block of the calling thread, create it on first use
+			* @return: Block&
+			*/
+			Block& local() {
+				thread_local std::vector<std::pair<const MetricsCounters*, Block*>> blocks;
+				thread_local std::pair<const MetricsCounters*, Block*> last{ nullptr, nullptr };
+				if (last.first == this)
+					return *last.second;
+				for (const auto& entry : blocks) {
+					if (entry.first == this) {
+						last = entry;
+						return *entry.second;
+					}
+				}
+
+				Block* block = new Block();
+				block->next = m_head.load(std::memory_order_relaxed);
+				while (!m_head.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+					;
+				blocks.emplace_back(this, block);
+				last = blocks.back();
+				return *block;
+			}
+
+			/*
+			* Sum the blocks of every thread into a snapshot
+			* @param t_metrics: LoggerMetrics, the per thread counters are added to it
+			*/
+			void collect(LoggerMetrics& t_metrics) const noexcept {
+				for (const Block* block = m_head.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+					for (size_t i = 0; i < metrics::levelCount; i++) {
+						t_metrics.accepted[i] += block->accepted[i].load(std::memory_order_relaxed);
+						t_metrics.filtered[i] += block->filtered[i].load(std::memory_order_relaxed);
+					}
+					t_metrics.formatNs += block->formatNs.load(std::memory_order_relaxed);
+					t_metrics.writeNs += block->writeNs.load(std::memory_order_relaxed);
+					t_metrics.lockWaitNs += block->lockWaitNs.load(std::memory_order_relaxed);
+				}
+			}
+
+		private:
+			std::atomic<Block*> m_head{ nullptr };
+		}; // end of class
+
+		namespace metrics {
+			/*
+			* Append a label value, backslash, quote and new line are escaped
+			*/
+			inline void appendLabel(std::string& out, const std::string& t_value) {
+				for (char c : t_value) {
+					if (c == '\\' || c == '"')
+						out += '\\';
+					if (c == '\n') {
+						out += "\\n";
+						continue;
+					}
+					out += c;
+				}
+			}
+
+			inline void appendHeader(std::string& out, const char* t_name, const char* t_help) {
+				out += "# HELP ";
+				out += t_name;
+				out += ' ';
+				out += t_help;
+				out += "\n# TYPE ";
+				out += t_name;
+				out += " counter\n";
+			}
+
+			/*
+			* Append one sample: name{logger="...",label="value"} value
+			*/
+			inline void appendSample(std::string& out, const char* t_name, const std::string& t_logger,
+				const char* t_label, const std::string& t_labelValue, uint64_t t_value) {
+				out += t_name;
+				out += "{logger=\"";
+				appendLabel(out, t_logger);
+				out += '"';
+				if (t_label != nullptr) {
+					out += ',';
+					out += t_label;
+					out += "=\"";
+					appendLabel(out, t_labelValue);
+					out += '"';
+				}
+				out += "} ";
+				appendUnsigned(out, t_value);
+				out += '\n';
+			}
+
+			inline void appendLevels(std::string& out, const char* t_name, const char* t_help, const std::string& t_logger,
+				const uint64_t (&t_counts)[levelCount]) {
+				appendHeader(out, t_name, t_help);
+				for (size_t i = 0; i < levelCount; i++) {
+					const char* name = levelName(levelAt(i));
+					if (name != nullptr)
+						appendSample(out, t_name, t_logger, "level", name, t_counts[i]);
+				}
+			}
+
+			inline void appendSinks(std::string& out, const char* t_name, const char* t_help, const std::string& t_logger,
+				const std::vector<SinkMetrics>& t_sinks, uint64_t SinkMetrics::* t_member) {
+				appendHeader(out, t_name, t_help);
+				std::string index;
+				for (size_t i = 0; i < t_sinks.size(); i++) {
+					index.clear();
+					appendUnsigned(index, i);
+					appendSample(out, t_name, t_logger, "sink", index, t_sinks[i].*t_member);
+				}
+			}
+		} // end of metrics namespace
+
+		/*
+		* Append a snapshot in the Prometheus text exposition format
+		* Example: tlog_messages_accepted_total{logger="net",level="info"} 120
+		* @param out: string output buffer
+		* @param t_metrics: LoggerMetrics
+		* @param t_logger: name of the logger in UTF-8, the default logger has an empty name
+		*/
+		inline void appendPrometheus(std::string& out, const LoggerMetrics& t_metrics, const std::string& t_logger) {
+			using namespace metrics;
+			appendLevels(out, "tlog_messages_accepted_total", "Records which passed the level check.", t_logger, t_metrics.accepted);
+			appendLevels(out, "tlog_messages_filtered_total", "Log calls rejected by the level check.", t_logger, t_metrics.filtered);
+			appendLevels(out, "tlog_messages_dropped_total", "Records dropped by the overflow policy of the async queue.", t_logger, t_metrics.dropped);
+			appendHeader(out, "tlog_format_nanoseconds_total", "Time spent capturing and formatting records.");
+			appendSample(out, "tlog_format_nanoseconds_total", t_logger, nullptr, std::string(), t_metrics.formatNs);
+			appendHeader(out, "tlog_write_nanoseconds_total", "Time spent in the write calls of the sinks.");
+			appendSample(out, "tlog_write_nanoseconds_total", t_logger, nullptr, std::string(), t_metrics.writeNs);
+			appendHeader(out, "tlog_lock_wait_nanoseconds_total", "Time spent waiting for the lock of the logger.");
+			appendSample(out, "tlog_lock_wait_nanoseconds_total", t_logger, nullptr, std::string(), t_metrics.lockWaitNs);
+			appendSinks(out, "tlog_sink_written_bytes_total", "Bytes written by each sink.", t_logger, t_metrics.sinks, &SinkMetrics::bytesWritten);
+			appendSinks(out, "tlog_sink_rotations_total", "Log file rotations of each sink.", t_logger, t_metrics.sinks, &SinkMetrics::rotations);
+			appendSinks(out, "tlog_sink_write_errors_total", "Failed writes of each sink.", t_logger, t_metrics.sinks, &SinkMetrics::writeErrors);
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,1505 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include "Formatter.h"
+#include "AsyncQueue.h"
+#include "ArgEncoder.h"
+#include "Sink.h"
+#include "FileSink.h"
+#include "Metrics.h"
+#include "CrashHandler.h"
+#include "FlushTimer.h"
+
+namespace aricanli {
+	namespace general {
+
+		// LogOutput enum class
+		// Possible ways to stream
+		enum class LogOutput {
+			Console,
+			File
+		};
+
+		// OverflowPolicy enum class
+		// What a log call does in async mode when the queue or its memory limit is full
+		enum class OverflowPolicy {
+			Block,		// wait until the writer thread makes room, default
+			DropNewest,	// drop the record of the call
+			DropOldest,	// drop the oldest waiting record to make room
+			DropBelow	// drop records less severe than the threshold, block for the others
+		};
+
+		// Class NamedLogger<T>
+		// One logger with its own sinks, level, pattern, lock and async queue.
+		// Loggers are created by Logger<T>::getLogger() and live until the end of the program,
+		// so the returned reference can be kept instead of looking the name up again.
+		// The static functions of Logger<T> use the logger with the empty name.
+		// A sink is written under the lock of its logger, add it to one logger only.
+		// Example:
+		//	auto& net = Logger<char>::getLogger("net");
+		//	net.setLogOutput("log/net.txt");
+		//	net.setLogFormat();
+		//	net.setLogPriority(LogPriority::Info);
+		//	LOG_INFO_L(net, "connected to", host);
+		template <typename T>
+		class NamedLogger : public crash::Target, public FlushTimer::Client {
+		public:
+			explicit NamedLogger(std::basic_string<T> t_name) : m_name(std::move(t_name)) {
+				for (auto& dropped : m_dropped)
+					dropped.store(0, std::memory_order_relaxed);
+				for (auto& sink : m_directSinks)
+					sink.store(nullptr, std::memory_order_relaxed);
+				m_crashMessage.reserve(4096);
+				m_crashLine.reserve(4096);
+				m_crashNode = crash::addTarget(this);
+			}
+			NamedLogger(const NamedLogger&) = delete;
+			NamedLogger& operator=(const NamedLogger&) = delete;
+			~NamedLogger() noexcept {
+				crash::removeTarget(m_crashNode);
+				stopWorker();
+				if (m_flushTimer)
+					m_flushTimer->cancel(this);
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				flushOutput();
+				if (m_fileSink)
+					m_fileSink->close();
+			}
+
+			const std::basic_string<T>& name() const noexcept {
+				return m_name;
+			}
+
+			/*
+			* Not set or call for stream to console
+			* Set log path as std::basic_string for stream to file
+			* @param t_filePath : basic_string<T>
+			*/
+			void setLogOutput(std::basic_string<T> t_filePath) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_logPath = t_filePath;
+			}
+
+			/*
+			* Set log priority level
+			* @param t_logPriority: enum class LogPriority
+			*/
+			void setLogPriority(LogPriority t_logPriority) {
+				m_logPriority.store(t_logPriority, std::memory_order_relaxed);
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				updateSinks();
+			}
+
+			/*
+			* Add a sink beside the default one
+			* records are formatted once for every distinct pattern and skipped
+			* without formatting when no sink accepts their level
+			* @param t_sink: shared_ptr<Sink<T>>
+			*/
+			void addSink(std::shared_ptr<Sink<T>> t_sink) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				selectDefaultSink(false);
+				attachSink(t_sink);
+				m_sinks.push_back(std::move(t_sink));
+				updateSinks();
+			}
+
+			/*
+			* Remove a sink, the default sink can be removed too
+			* @param t_sink: shared_ptr<Sink<T>>
+			*/
+			void removeSink(const std::shared_ptr<Sink<T>>& t_sink) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				selectDefaultSink(false);
+				for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+					if (*it == t_sink) {
+						t_sink->flush();
+						t_sink->onLevelChange(nullptr);
+						retireSink(t_sink);
+						m_sinks.erase(it);
+						break;
+					}
+				}
+				updateSinks();
+			}
+
+			/*
+			* Replace all sinks including the default one
+			* setLogFormat() adds the default sink back
+			* @param t_sinks: vector<shared_ptr<Sink<T>>>
+			*/
+			void setSinks(std::vector<std::shared_ptr<Sink<T>>> t_sinks) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_defaultSelected = true;
+				for (auto& sink : m_sinks) {
+					sink->flush();
+					sink->onLevelChange(nullptr);
+					retireSink(sink);
+				}
+				m_sinks = std::move(t_sinks);
+				for (auto& sink : m_sinks)
+					attachSink(sink);
+				updateSinks();
+			}
+
+			/*
+			* Enable or disable asynchronous logging
+			* In async mode log() only pushes the record into a bounded lock-free queue
+			* and returns, a writer thread owned by the logger formats and writes it.
+			* Disabling the mode drains the queue before returning.
+			* Switch the mode while no other thread is logging.
+			* @param t_async: bool
+			* @param t_queueCapacity: maximum number of records waiting in the queue
+			*/
+			void setAsyncMode(bool t_async, size_t t_queueCapacity = 8192) {
+				if (t_async)
+					startWorker(t_queueCapacity);
+				else
+					stopWorker();
+			}
+
+			/*
+			* Enable or disable deferred formatting of async records
+			* The calling thread only copies the arguments into a compact binary record,
+			* converting them to text is left to the writer thread.
+			* Strings marked with literal() are kept by pointer, other strings are copied.
+			* Arguments which do not fit in TLOG_RECORD_ARGS_SIZE bytes are formatted eagerly.
+			* @param t_deferred: bool
+			*/
+			void setDeferredFormat(bool t_deferred) {
+				m_deferred.store(t_deferred, std::memory_order_relaxed);
+			}
+
+			/*
+			* Select what a log call does in async mode when the queue is full
+			* or the records waiting in it hold more memory than setQueueMemoryLimit() allows.
+			* Example: setOverflowPolicy(OverflowPolicy::DropBelow, LogPriority::Error)
+			* drops Warning and less severe records, Fatal and Error wait for room.
+			* @param t_policy: OverflowPolicy
+			* @param t_threshold: least severe level which is not dropped by OverflowPolicy::DropBelow
+			*/
+			void setOverflowPolicy(OverflowPolicy t_policy, LogPriority t_threshold = LogPriority::Error) {
+				m_overflowThreshold.store(t_threshold, std::memory_order_relaxed);
+				m_overflowPolicy.store(t_policy, std::memory_order_relaxed);
+			}
+
+			/*
+			* Limit the memory held by the records waiting in the async queue
+			* a record counts its struct and the capacity of its buffers, a single record
+			* is always accepted by an empty queue
+			* @param t_bytes: 0 for no limit, default
+			*/
+			void setQueueMemoryLimit(size_t t_bytes) {
+				m_memoryLimit.store(t_bytes, std::memory_order_relaxed);
+			}
+
+			/*
+			* Set how often the writer thread writes a Warning record with the number of
+			* records dropped since the previous one, counted per level
+			* @param t_interval: default 1 s, 0 disables the record
+			*/
+			void setDropReportInterval(std::chrono::milliseconds t_interval) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_dropReportInterval = t_interval;
+			}
+
+			/*
+			* Get the number of records of given level dropped since the logger was created
+			* @param messageLevel: Log Level
+			* @return: uint64_t
+			*/
+			uint64_t droppedCount(LogPriority messageLevel) const noexcept {
+				return m_dropped[metrics::levelIndex(messageLevel)].load(std::memory_order_relaxed);
+			}
+
+			/*
+			* Get the number of records of every level dropped since the logger was created
+			* @return: uint64_t
+			*/
+			uint64_t droppedCount() const noexcept {
+				uint64_t total = 0;
+				for (const auto& dropped : m_dropped)
+					total += dropped.load(std::memory_order_relaxed);
+				return total;
+			}
+
+			/*
+			* Block until every record logged before the call is written
+			* and flush the sinks
+			*/
+			void flush() {
+				if (m_async.load(std::memory_order_acquire)) {
+					for (;;) {
+						{
+							std::lock_guard<std::mutex> _lock(m_mutex);
+							if (m_queue->empty()) {
+								flushOutput();
+								return;
+							}
+						}
+						std::this_thread::yield();
+					}
+				}
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				flushOutput();
+			}
+
+			/*
+			* Check the runtime level and the levels of the sinks without taking the lock
+			* LOG_* macros call it before evaluating their arguments
+			* @param messageLevel: Log Level
+			*/
+			bool isEnabled(LogPriority messageLevel) const noexcept {
+				return messageLevel <= m_activePriority.load(std::memory_order_relaxed);
+			}
+
+			void log(LogPriority messageLevel) {} // For Quiet priority
+
+			/*
+			* Log given message with defined parameters and pass it to the sinks
+			* @param messageLevel: Log Level
+			* @param ...args: Variadic template arguments
+			*/
+			template<typename ...Args>
+			void log(LogPriority messageLevel, Args &&...args) {
+				logAt(nullptr, messageLevel, std::forward<Args>(args)...);
+			}
+
+			void logAt(const LogSite* t_site, LogPriority messageLevel) {} // For Quiet priority
+
+			/*
+			* Log given message with the call site of %f, %l and %F, used by the LOG_* macros
+			* @param t_site: static LogSite of the call, nullptr if unknown
+			* @param messageLevel: Log Level
+			* @param ...args: Variadic template arguments
+			*/
+			template<typename ...Args>
+			void logAt(const LogSite* t_site, LogPriority messageLevel, Args &&...args) {
+
+				if (!isEnabled(messageLevel) || priorityToString(messageLevel) == nullptr) {
+					countFiltered(messageLevel);
+					return;
+				}
+				// only passes isEnabled() for the levels kept by setBacktrace()
+				if (messageLevel > m_logPriority.load(std::memory_order_relaxed)) {
+					recordBacktrace(t_site, messageLevel, std::forward<Args>(args)...);
+					countFiltered(messageLevel);
+					return;
+				}
+
+				MetricsCounters::Block* counters = m_metricsEnabled.load(std::memory_order_relaxed) ? &m_counters.local() : nullptr;
+				if (messageLevel == LogPriority::Fatal && m_fatalDirect.load(std::memory_order_relaxed)) {
+					logFatal(t_site, counters, std::forward<Args>(args)...);
+					return;
+				}
+				if (messageLevel <= m_backtraceTrigger.load(std::memory_order_relaxed) &&
+					m_backtraceNext.load(std::memory_order_relaxed) != m_backtraceDumped.load(std::memory_order_relaxed))
+					dumpBacktrace();
+				if (m_async.load(std::memory_order_acquire)) {
+					pushRecord(t_site, counters, messageLevel, std::forward<Args>(args)...);
+					return;
+				}
+
+				std::unique_lock<std::mutex> _lock(m_mutex, std::defer_lock);
+				lockTimed(_lock, counters);
+				auto start = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+				captureRecord(m_record, t_site, messageLevel, m_binarySinks != 0, std::forward<Args>(args)...);
+				if (counters != nullptr) {
+					metrics::bump(counters->accepted[metrics::levelIndex(messageLevel)], 1);
+					metrics::bump(counters->formatNs, metrics::elapsedNs(start));
+				}
+				writeRecord(m_record, counters);
+			}
+
+			/*
+			* Count a log call rejected by the level check when metrics are enabled
+			* LOG_* macros call it instead of log()
+			* @param messageLevel: Log Level
+			*/
+			void countFiltered(LogPriority messageLevel) {
+				if (m_metricsEnabled.load(std::memory_order_relaxed))
+					countFilteredSlow(messageLevel);
+			}
+
+			/*
+			* Enable or disable the counters of metrics(), disabled by default
+			* Counters are kept per thread, a log call only writes to the block of its own thread.
+			* Timing the formatting, the writes and the lock adds a few clock reads per record.
+			* @param t_enabled: bool
+			*/
+			void setMetricsEnabled(bool t_enabled) {
+				m_metricsEnabled.store(t_enabled, std::memory_order_relaxed);
+			}
+
+			/*
+			* Sum the counters of every thread and read the counters of the sinks
+			* @return: LoggerMetrics
+			*/
+			LoggerMetrics metrics() {
+
+				LoggerMetrics result;
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				collectMetrics(result);
+				return result;
+			}
+
+			/*
+			* Write the metrics periodically, checked when a record is written
+			* An empty path writes them as an Info record of this logger with a field for every counter,
+			* otherwise the file is replaced with a snapshot in the Prometheus text format.
+			* Example: setMetricsDump(std::chrono::seconds(10), "/var/lib/node_exporter/tlog.prom")
+			* @param t_interval: 0 disables the dump, default
+			* @param t_prometheusPath: UTF-8 path of the file
+			*/
+			void setMetricsDump(std::chrono::milliseconds t_interval, const std::string& t_prometheusPath = std::string()) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_metricsInterval = t_interval;
+				m_metricsPath = t_prometheusPath;
+				m_nextMetricsDump = std::chrono::system_clock::now() + t_interval;
+			}
+
+			/*
+			* Let Fatal records bypass the lock of the logger and the async queue
+			* A Fatal record waits up to 100 ms for the lock, writes the records waiting in the
+			* queue before itself and flushes the sinks. If the lock is still held, e.g. by a thread
+			* which hangs in a sink, the record is formatted on the calling thread and written
+			* with Sink::writeDirect(), ahead of the text the other thread has buffered.
+			* @param t_enabled: bool, disabled by default
+			*/
+			void setFatalDirectWrite(bool t_enabled) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_fatalDirect.store(t_enabled, std::memory_order_relaxed);
+				updateSinks();
+			}
+
+			/*
+			* Keep the records which are less severe than the level of the logger in a ring buffer
+			* The records are captured with their arguments encoded like deferred records, formatting
+			* and writing them is left to dumpBacktrace(). A record of the trigger level or a more
+			* severe one writes the ring before itself, so e.g. an Error is preceded by the Debug
+			* records which led to it. The ring is shared by the threads, a record claims its slot with
+			* an atomic counter and does not take a lock. It is dropped if the slot is still being
+			* written by a record a whole ring earlier or being dumped.
+			* Fatal records written with setFatalDirectWrite() skip the dump.
+			* @param t_records: size of the ring, 0 disables it
+			* @param t_trigger: least severe level which writes the ring, LogPriority::Quiet only writes it on dumpBacktrace()
+			* @param t_captureLevel: most verbose level kept in the ring
+			*/
+			void setBacktrace(size_t t_records, LogPriority t_trigger = LogPriority::Error, LogPriority t_captureLevel = LogPriority::Trace) {
+				{
+					std::lock_guard<std::mutex> _ring(m_backtraceMutex);
+					std::unique_ptr<BacktraceRing> ring(t_records != 0 ? new BacktraceRing(t_records) : nullptr);
+					m_backtraceDumped.store(m_backtraceNext.load(std::memory_order_relaxed), std::memory_order_relaxed);
+					m_backtrace.store(ring.get(), std::memory_order_release);
+					// a record may still be captured into the previous ring
+					if (ring)
+						m_backtraceRings.push_back(std::move(ring));
+					m_backtraceTrigger.store(t_trigger, std::memory_order_relaxed);
+					m_backtraceLevel.store(t_records != 0 ? t_captureLevel : LogPriority::Quiet, std::memory_order_relaxed);
+				}
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				updateSinks();
+			}
+
+			/*
+			* Write the records of the ring buffer, oldest first, and empty it
+			* in async mode they are pushed into the queue
+			*/
+			void dumpBacktrace() {
+
+				std::lock_guard<std::mutex> _ring(m_backtraceMutex);
+				BacktraceRing* ring = m_backtrace.load(std::memory_order_relaxed);
+				const uint64_t last = m_backtraceNext.load(std::memory_order_acquire);
+				uint64_t first = m_backtraceDumped.load(std::memory_order_relaxed) + 1;
+				if (ring == nullptr || first > last)
+					return;
+				if (last - first >= ring->size)
+					first = last - ring->size + 1;
+				m_backtraceDumped.store(last, std::memory_order_relaxed);
+
+				const bool async = m_async.load(std::memory_order_acquire);
+				std::unique_lock<std::mutex> _lock(m_mutex, std::defer_lock);
+				if (!async)
+					_lock.lock();
+				for (uint64_t ticket = first; ticket <= last; ticket++) {
+					BacktraceSlot& slot = ring->slots[ticket % ring->size];
+					// waits for a record which is being captured into the slot
+					while (slot.busy.exchange(true, std::memory_order_acquire))
+						std::this_thread::yield();
+					if (slot.ticket == ticket) {
+						if (async)
+							enqueueRecord(slot.record);
+						else
+							writeRecord(slot.record);
+					}
+					slot.busy.store(false, std::memory_order_release);
+				}
+			}
+
+			/*
+			* Called by the crash handler, see installCrashHandler()
+			* Writes the buffers of the sinks, then the records waiting in the async queue as
+			* "LEVEL: message" lines and the crash report with Sink::writeDirect().
+			* In a signal handler no lock is taken, the records are read in place and decoded
+			* into a fixed buffer, longer lines are cut. From the std::terminate hook the lock is
+			* taken if it is free within 100 ms and the records are formatted as usual.
+			* @param t_report: UTF-8 lines of the crash report
+			* @param t_length: number of bytes
+			* @param t_signal: called from a signal handler
+			*/
+			void emergencyDrain(const char* t_report, size_t t_length, bool t_signal) noexcept override {
+
+				std::unique_lock<std::mutex> _lock(m_mutex, std::defer_lock);
+				if (!t_signal)
+					tryLockFor(_lock, std::chrono::milliseconds(100));
+				const size_t count = m_directCount.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; i++) {
+					Sink<T>* sink = m_directSinks[i].load(std::memory_order_acquire);
+					if (sink != nullptr)
+						sink->emergencyFlush();
+				}
+
+				if (m_queue && t_signal) {
+					while (m_queue->tryConsume([this](const LogRecord<T>& record) { writeCrashLine(record); }))
+						;
+				}
+				else if (m_queue) {
+					try {
+						while (m_queue->tryPop(m_crashRecord)) {
+							m_crashMessage.clear();
+							appendMessage(m_crashMessage, m_crashRecord);
+							m_crashMessage += '\n';
+							m_crashLine.clear();
+							appendChars(m_crashLine, m_crashMessage.data(), m_crashMessage.size());
+							writeDirect(m_crashRecord.level, m_crashLine.data(), m_crashLine.size());
+						}
+					}
+					catch (...) {
+					}
+				}
+				writeDirect(LogPriority::Fatal, t_report, t_length);
+			}
+
+			/*
+			* Set the pattern of the sinks without their own one, default as %m %t
+			* formatPattern::JSON and formatPattern::LOGFMT write the fields of the pattern
+			* as keys, %m stands for the level, the message and the named arguments
+			* Example: setFormatter("%t %m %f %l", formatPattern::JSON)
+			* @param t_fmt: basic_string<T>
+			* @param t_layout: formatPattern
+			*/
+			void setFormatter(const std::basic_string<T>& t_fmt, formatPattern t_layout = formatPattern::TEXT) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				Formatter<T>::recompile(m_pattern, t_fmt, t_layout);
+				updateSinks();
+			}
+
+			/*
+			* Set precision and time zone of %t for the pattern of the logger and of its sinks,
+			* default is milliseconds in local time
+			* @param t_precision: TimePrecision
+			* @param t_zone: TimeZone
+			*/
+			void setTimestampFormat(TimePrecision t_precision, TimeZone t_zone = TimeZone::Local) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_pattern.precision = t_precision;
+				m_pattern.zone = t_zone;
+				updateSinks();
+			}
+
+			/*
+			* Set file's limit (byte)
+			*/
+			void setFileLimit(unsigned long long  t_fileLimit) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileLimit(t_fileLimit);
+			}
+
+			/*
+			* Set rotation of the log file
+			* When the file limit is reached or the interval elapses log.txt is renamed to log.1.txt,
+			* log.1.txt to log.2.txt and so on, the oldest backup beyond t_maxBackups is removed.
+			* With 0 backups the file is truncated.
+			* Rotation runs on the thread which writes the record, in async mode that is the writer thread.
+			* @param t_maxBackups: number of rotated files kept
+			* @param t_interval: RotationInterval
+			*/
+			void setFileRotation(size_t t_maxBackups, RotationInterval t_interval = RotationInterval::None) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileRotation(t_maxBackups, t_interval);
+			}
+
+			/*
+			* Compress rotated log files in a background thread and apply a retention policy, requires C++17
+			* The logging threads only queue the rotated file, they never wait for the compression.
+			* @param t_compression: Compression::Gzip or Compression::Zstd
+			* @param t_maxTotalBytes: size limit of the rotated files, 0 for no limit
+			*/
+			void setFileCompression(Compression t_compression, unsigned long long t_maxTotalBytes = 0) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileCompression(t_compression, t_maxTotalBytes);
+			}
+
+			/*
+			* Select how the log file is written, reopen the file if it is already open
+			* FileBackend::Stream : ofstream, default
+			* FileBackend::Posix : raw descriptor in append mode with a user-space buffer
+			* FileBackend::Mapped : records are copied into a memory mapping of the file,
+			* the file is extended in chunks and trimmed when it is closed or rotated
+			* wchar_t records are written in UTF-8 by Posix and Mapped
+			* @param t_backend: FileBackend
+			*/
+			void setFileBackend(FileBackend t_backend) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileBackend(t_backend);
+			}
+
+			/*
+			* Select the layout of the log file, reopen the file if it is already open
+			* FileFormat::Text : records formatted with the pattern of setFormatter(), default
+			* FileFormat::Binary : arguments are written in a compact binary form, strings marked with
+			* literal() once per file, read it back with tools/tlog_decode
+			* A binary file is written with FileBackend::Posix unless FileBackend::Mapped is selected,
+			* the console output is always text
+			* @param t_format: FileFormat
+			*/
+			void setFileFormat(FileFormat t_format) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileFormat(t_format);
+				updateSinks();
+			}
+
+			/*
+			* Set when the buffer of FileBackend::Posix is written to the file
+			* flush() and the destructor always write it, a shared timer thread writes the
+			* records of an idle buffer when they are older than the interval
+			* @param t_policy: FlushPolicy
+			* @param t_bufferSize: bytes collected before a write, default 64 KB
+			* @param t_interval: maximum time a record waits in the buffer, default 200 ms
+			*/
+			void setFileFlushPolicy(FlushPolicy t_policy, size_t t_bufferSize = 64 * 1024,
+				std::chrono::milliseconds t_interval = std::chrono::milliseconds(200)) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileFlushPolicy(t_policy, t_bufferSize, t_interval);
+			}
+
+			/*
+			* Set size of the window mapped at once by FileBackend::Mapped, default 64 MB
+			* takes effect when the file is opened next time
+			* @param t_chunkSize: bytes
+			*/
+			void setFileMapChunk(size_t t_chunkSize) {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				fileSink().setFileMapChunk(t_chunkSize);
+			}
+
+			/*
+			* Set output format
+			* if m_logPath is empty then stream to console
+			* if m_logPath is not empty then stream to file
+			*/
+			void setLogFormat() {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				selectDefaultSink(true);
+			}
+
+		protected:
+			/*
+			* Get the file sink used as the default sink, created on first use
+			* @return: FileSink<T>&
+			*/
+			FileSink<T>& fileSink() {
+				if (!m_fileSink)
+					m_fileSink = std::make_shared<FileSink<T>>();
+				return *m_fileSink;
+			}
+
+			/*
+			* Put the console or the file sink in place of the default sink
+			* opens the file of m_logPath
+			* @param t_reselect: false keeps the default sink if it is already selected
+			*/
+			void selectDefaultSink(bool t_reselect) {
+
+				if (m_defaultSelected && !t_reselect)
+					return;
+				m_defaultSelected = true;
+
+				std::shared_ptr<Sink<T>> sink;
+				if (m_logPath.empty()) {
+					m_logOutput = LogOutput::Console;
+					if (!m_consoleSink)
+						m_consoleSink = std::make_shared<ConsoleSink<T>>();
+					if (m_fileSink)
+						m_fileSink->close();
+					sink = m_consoleSink;
+				}
+				else {
+					m_logOutput = LogOutput::File;
+					fileSink().open(m_logPath);
+					sink = m_fileSink;
+				}
+
+				auto it = m_sinks.begin();
+				for (; it != m_sinks.end(); ++it)
+					if (*it == m_defaultSink)
+						break;
+				if (it != m_sinks.end())
+					*it = sink;
+				else
+					m_sinks.insert(m_sinks.begin(), sink);
+				m_defaultSink = sink;
+				attachSink(sink);
+				updateSinks();
+			}
+
+			/*
+			* Let the sink report level changes to the logger
+			*/
+			void attachSink(const std::shared_ptr<Sink<T>>& t_sink) {
+				t_sink->onLevelChange([this] {
+					std::lock_guard<std::mutex> _lock(m_mutex);
+					updateSinks();
+				});
+			}
+
+			/*
+			* Recompute the most verbose level accepted by any sink and the number of binary sinks
+			* called with m_mutex held
+			*/
+			void updateSinks() {
+
+				selectDefaultSink(false);
+				LogPriority most = LogPriority::Quiet;
+				size_t binary = 0;
+				for (const auto& sink : m_sinks) {
+					sink->useTimestamp(m_pattern.precision, m_pattern.zone);
+					if (sink->level() > most)
+						most = sink->level();
+					if (!sink->textOutput())
+						binary++;
+				}
+				LogPriority level = m_logPriority.load(std::memory_order_relaxed);
+				LogPriority captured = m_backtraceLevel.load(std::memory_order_relaxed);
+				if (captured > level)
+					level = captured;
+				m_activePriority.store(most < level ? most : level, std::memory_order_relaxed);
+				m_binarySinks = binary;
+				m_formatted.resize(m_sinks.size());
+				m_formattedPattern.resize(m_sinks.size());
+
+				// sinks reached without the lock by Fatal records and the crash handler
+				const size_t count = m_sinks.size() < maxDirectSinks ? m_sinks.size() : maxDirectSinks;
+				m_directCount.store(0, std::memory_order_release);
+				for (size_t i = 0; i < count; i++)
+					m_directSinks[i].store(m_sinks[i].get(), std::memory_order_release);
+				m_directCount.store(count, std::memory_order_release);
+				std::atomic_store(&m_directPattern, std::make_shared<const FormatPattern<T>>(m_pattern));
+			}
+
+			/*
+			* Return the prefix written in front of the messages of given level
+			* @param messageLevel: Log Level
+			* @return: nullptr for Quiet and unknown levels
+			*/
+			static const char* priorityToString(LogPriority messageLevel) noexcept {
+				switch (messageLevel) {
+				case LogPriority::Fatal:
+					return "FATAL:";
+				case LogPriority::Error:
+					return "ERROR:";
+				case LogPriority::Warning:
+					return "WARNING:";
+				case LogPriority::Info:
+					return "INFO:";
+				case LogPriority::Verbose:
+					return "VERBOSE:";
+				case LogPriority::Debug:
+					return "DEBUG:";
+				case  LogPriority::Trace:
+					return "TRACE:";
+				default:
+					return nullptr;
+				}
+			}
+
+			/*
+			* Capture the time and the arguments of a message into a record
+			* the record is reused, its message keeps the capacity of earlier messages
+			* @param record: LogRecord<T>
+			* @param t_site: LogSite of the call, nullptr if unknown
+			* @param messageLevel: Log Level
+			* @param t_encode: keep the arguments encoded if they fit, otherwise format them
+			* @param ...args: Variadic template arguments
+			*/
+			template <typename ...Args>
+			static void captureRecord(LogRecord<T>& record, const LogSite* t_site, LogPriority messageLevel, bool t_encode, Args &&...args) {
+
+				record.level = messageLevel;
+				record.site = t_site;
+				record.time = std::chrono::system_clock::now();
+
+				using Decoder = ArgDecoder<T, StoredArg<Args>...>;
+				record.args.size = 0;
+				record.message.clear();
+				record.fields.clear();
+				if (t_encode && Decoder::encode(record.args, args...)) {
+					record.argFormat = Decoder::format();
+				}
+				else {
+					record.args.size = 0;
+					record.argFormat = nullptr;
+					Formatter<T>::captureMessage(record.message, record.fields, std::forward<Args>(args)...);
+				}
+			}
+
+			/*
+			* Capture the message on the calling thread and push it into the async queue
+			* when the queue is full the overflow policy decides between waiting with yield
+			* and dropping a record
+			* The record of the thread is swapped with a consumed one, so its message
+			* buffer is reused and nothing is allocated in steady state
+			* @param t_site: LogSite of the call, nullptr if unknown
+			* @param counters: block of the calling thread, nullptr if metrics are disabled
+			* @param messageLevel: Log Level
+			* @param ...args: Variadic template arguments
+			*/
+			template <typename ...Args>
+			void pushRecord(const LogSite* t_site, MetricsCounters::Block* counters, LogPriority messageLevel, Args &&...args) {
+
+				thread_local LogRecord<T> record;
+				auto start = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+				captureRecord(record, t_site, messageLevel, m_deferred.load(std::memory_order_relaxed), std::forward<Args>(args)...);
+				if (counters != nullptr) {
+					metrics::bump(counters->accepted[metrics::levelIndex(messageLevel)], 1);
+					metrics::bump(counters->formatNs, metrics::elapsedNs(start));
+				}
+				enqueueRecord(record);
+			}
+
+			/*
+			* Push a captured record into the async queue under the overflow policy
+			* @param record: LogRecord<T>, receives a consumed record of the queue
+			*/
+			void enqueueRecord(LogRecord<T>& record) {
+
+				const LogPriority messageLevel = record.level;
+				const size_t bytes = recordBytes(record);
+				const OverflowPolicy policy = m_overflowPolicy.load(std::memory_order_relaxed);
+				for (;;) {
+					if (reserveBytes(bytes)) {
+						if (m_queue->tryPush(record)) {
+							// pairs with the fence of waitForRecords()
+							std::atomic_thread_fence(std::memory_order_seq_cst);
+							if (m_sleeping.load(std::memory_order_relaxed))
+								wakeWorker();
+							return;
+						}
+						m_queuedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+					}
+
+					if (policy == OverflowPolicy::DropNewest ||
+						(policy == OverflowPolicy::DropBelow && messageLevel > m_overflowThreshold.load(std::memory_order_relaxed))) {
+						countDrop(messageLevel);
+						return;
+					}
+					if (policy == OverflowPolicy::DropOldest) {
+						thread_local LogRecord<T> oldest;
+						if (m_queue->tryPop(oldest)) {
+							m_queuedBytes.fetch_sub(recordBytes(oldest), std::memory_order_relaxed);
+							countDrop(oldest.level);
+							continue;
+						}
+					}
+					std::this_thread::yield();
+				}
+			}
+
+			/*
+			* Capture a record below the level of the logger into the ring of setBacktrace()
+			* the slot is reused, its buffers keep the capacity of earlier records
+			* a slot may be dumped long after the call returned, so it owns the text of its
+			* arguments, only strings marked with literal() are kept by pointer
+			* the record takes the next ticket and writes the slot of the ticket without a lock
+			*/
+			template <typename ...Args>
+			void recordBacktrace(const LogSite* t_site, LogPriority messageLevel, Args &&...args) {
+
+				BacktraceRing* ring = m_backtrace.load(std::memory_order_acquire);
+				if (ring == nullptr)
+					return;
+				const uint64_t ticket = m_backtraceNext.fetch_add(1, std::memory_order_relaxed) + 1;
+				BacktraceSlot& slot = ring->slots[ticket % ring->size];
+				if (slot.busy.exchange(true, std::memory_order_acquire))
+					return;
+				// a record a whole ring later may have written the slot first
+				if (slot.ticket < ticket) {
+					captureRecord(slot.record, t_site, messageLevel, true, std::forward<Args>(args)...);
+					slot.ticket = ticket;
+				}
+				slot.busy.store(false, std::memory_order_release);
+			}
+
+			// kept out of line, countFiltered() is on the path of every rejected LOG_* call
+			void countFilteredSlow(LogPriority messageLevel) {
+				metrics::bump(m_counters.local().filtered[metrics::levelIndex(messageLevel)], 1);
+			}
+
+			/*
+			* Memory held by a record waiting in the queue
+			* @param record: LogRecord<T>
+			* @return: bytes
+			*/
+			static size_t recordBytes(const LogRecord<T>& record) noexcept {
+				return sizeof(LogRecord<T>) + record.message.capacity() * sizeof(T) + record.fields.capacity() * sizeof(FieldSpan);
+			}
+
+			/*
+			* Add a record to the bytes waiting in the queue if the memory limit allows
+			* @param t_bytes: recordBytes() of the record
+			* @return: false if the record does not fit
+			*/
+			bool reserveBytes(size_t t_bytes) noexcept {
+				const size_t limit = m_memoryLimit.load(std::memory_order_relaxed);
+				const size_t before = m_queuedBytes.fetch_add(t_bytes, std::memory_order_relaxed);
+				if (limit == 0 || before == 0 || before + t_bytes <= limit)
+					return true;
+				m_queuedBytes.fetch_sub(t_bytes, std::memory_order_relaxed);
+				return false;
+			}
+
+			void countDrop(LogPriority messageLevel) noexcept {
+				m_dropped[metrics::levelIndex(messageLevel)].fetch_add(1, std::memory_order_relaxed);
+				// a record larger than the memory limit is dropped while the queue may be empty
+				if (m_sleeping.load(std::memory_order_relaxed))
+					wakeWorker();
+			}
+
+			/*
+			* Write a Warning record with the number of records dropped since the last report
+			* the message holds the total and a field for every level, e.g.
+			* "WARNING: 120 messages dropped info=100 debug=20"
+			* called with m_mutex held
+			*/
+			void reportDrops() {
+
+				uint64_t counts[metrics::levelCount];
+				uint64_t total = 0;
+				for (size_t i = 0; i < metrics::levelCount; i++) {
+					counts[i] = m_dropped[i].load(std::memory_order_relaxed) - m_reported[i];
+					m_reported[i] += counts[i];
+					total += counts[i];
+				}
+				if (total == 0)
+					return;
+
+				m_dropRecord.level = LogPriority::Warning;
+				m_dropRecord.time = std::chrono::system_clock::now();
+				m_dropRecord.argFormat = nullptr;
+				m_dropRecord.site = nullptr;
+				m_dropRecord.args.size = 0;
+				m_dropRecord.message.clear();
+				m_dropRecord.fields.clear();
+				Formatter<T>::captureMessage(m_dropRecord.message, m_dropRecord.fields, total, "messages dropped");
+				for (size_t i = 0; i < metrics::levelCount; i++) {
+					if (counts[i] != 0)
+						Formatter<T>::captureMessage(m_dropRecord.message, m_dropRecord.fields,
+							field(levelName(metrics::levelAt(i)), counts[i]));
+				}
+				writeRecord(m_dropRecord);
+			}
+
+			/*
+			* Check whether records were dropped since the last report
+			* called with m_mutex held
+			* @return: bool
+			*/
+			bool dropsPending() const noexcept {
+				for (size_t i = 0; i < metrics::levelCount; i++) {
+					if (m_dropped[i].load(std::memory_order_relaxed) != m_reported[i])
+						return true;
+				}
+				return false;
+			}
+
+			/*
+			* Create the queue if needed and start the writer thread
+			* @param t_queueCapacity: maximum number of records waiting in the queue
+			*/
+			void startWorker(size_t t_queueCapacity) {
+
+				if (m_worker.joinable())
+					return;
+				if (!m_queue)
+					m_queue.reset(new AsyncQueue<LogRecord<T>>(t_queueCapacity));
+				m_running.store(true, std::memory_order_release);
+				m_worker = std::thread(&NamedLogger::workerLoop, this);
+				m_async.store(true, std::memory_order_release);
+			}
+
+			/*
+			* Stop accepting async records, write what is left in the queue
+			* and join the writer thread
+			*/
+			void stopWorker() noexcept {
+
+				m_async.store(false, std::memory_order_release);
+				if (!m_worker.joinable())
+					return;
+				m_running.store(false, std::memory_order_seq_cst);
+				wakeWorker();
+				m_worker.join();
+			}
+
+			// wake the writer thread parked in waitForRecords()
+			void wakeWorker() noexcept {
+				{
+					std::lock_guard<std::mutex> _wake(m_wakeMutex);
+					m_sleeping.store(false, std::memory_order_seq_cst);
+				}
+				m_wake.notify_one();
+			}
+
+			/*
+			* Park the writer thread until a record is pushed or the worker is stopped
+			* the flag is raised before the queue is checked and producers check it after
+			* their push, so a record pushed in between is never left waiting
+			* @param t_timed: wake at t_until even if nothing was pushed
+			* @param t_until: steady_clock::time_point
+			*/
+			void waitForRecords(bool t_timed, std::chrono::steady_clock::time_point t_until) {
+
+				m_sleeping.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (m_queue->empty() && m_running.load(std::memory_order_seq_cst)) {
+					std::unique_lock<std::mutex> _wake(m_wakeMutex);
+					auto woken = [this] { return !m_sleeping.load(std::memory_order_relaxed); };
+					if (t_timed)
+						m_wake.wait_until(_wake, t_until, woken);
+					else
+						m_wake.wait(_wake, woken);
+				}
+				m_sleeping.store(false, std::memory_order_relaxed);
+			}
+
+			/*
+			* Writer thread body
+			* drain the queue in batches under m_mutex, flush the sinks when the queue
+			* becomes empty, yield for a while and then park until a record is pushed
+			* while drops are waiting to be reported it wakes for the next report
+			*/
+			void workerLoop() {
+
+				const size_t batchSize = 256;
+				LogRecord<T> record;
+				unsigned idle = 0;
+				auto lastReport = std::chrono::steady_clock::now();
+				for (;;) {
+					size_t written = 0;
+					bool reportPending = false;
+					auto reportAt = lastReport;
+					{
+						MetricsCounters::Block* counters = m_metricsEnabled.load(std::memory_order_relaxed) ? &m_counters.local() : nullptr;
+						std::unique_lock<std::mutex> _lock(m_mutex, std::defer_lock);
+						lockTimed(_lock, counters);
+						while (written < batchSize && m_queue->tryPop(record)) {
+							m_queuedBytes.fetch_sub(recordBytes(record), std::memory_order_relaxed);
+							writeRecord(record, counters);
+							written++;
+						}
+						if (m_dropReportInterval.count() != 0) {
+							auto now = std::chrono::steady_clock::now();
+							if (now - lastReport >= m_dropReportInterval) {
+								lastReport = now;
+								reportDrops();
+							}
+							reportPending = dropsPending();
+							reportAt = lastReport + m_dropReportInterval;
+						}
+						if (written == 0 && idle == 0)
+							flushOutput();
+					}
+
+					if (written != 0) {
+						idle = 0;
+						continue;
+					}
+					if (!m_running.load(std::memory_order_acquire)) {
+						if (m_queue->empty())
+							break;
+						continue;
+					}
+					if (++idle < 64)
+						std::this_thread::yield();
+					else
+						waitForRecords(reportPending, reportAt);
+				}
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				if (m_dropReportInterval.count() != 0)
+					reportDrops();
+				flushOutput();
+			}
+
+			/*
+			* Build the message text of a record into m_message, deferred arguments are decoded here
+			* the text of the arguments starts at m_messageOffset, after the level prefix
+			* @param record: LogRecord<T>
+			* @return: basic_string<T> in the same layout as Formatter::formatMessage()
+			*/
+			const std::basic_string<T>& messageOf(const LogRecord<T>& record) {
+
+				m_message.clear();
+				m_messageOffset = appendMessage(m_message, record);
+				return m_message;
+			}
+
+			/*
+			* Append the level prefix and the message text of a record
+			* @param out: basic_string<T> output buffer
+			* @param record: LogRecord<T>
+			* @return: offset of the text of the arguments in out
+			*/
+			static size_t appendMessage(std::basic_string<T>& out, const LogRecord<T>& record) {
+
+				for (const char* t_priority = priorityToString(record.level); *t_priority != '\0'; t_priority++)
+					out += static_cast<T>(*t_priority);
+				out += ' ';
+				size_t offset = out.size();
+				if (record.argFormat != nullptr)
+					record.argFormat->decode(record.args.data, out);
+				else
+					out += record.message;
+				return offset;
+			}
+
+			/*
+			* Write a Fatal record, see setFatalDirectWrite()
+			* @param t_site: LogSite of the call, nullptr if unknown
+			* @param counters: block of the calling thread, nullptr if metrics are disabled
+			* @param ...args: Variadic template arguments
+			*/
+			template <typename ...Args>
+			void logFatal(const LogSite* t_site, MetricsCounters::Block* counters, Args &&...args) {
+
+				if (counters != nullptr)
+					metrics::bump(counters->accepted[metrics::levelIndex(LogPriority::Fatal)], 1);
+				std::unique_lock<std::mutex> _lock(m_mutex, std::defer_lock);
+				if (tryLockFor(_lock, std::chrono::milliseconds(100))) {
+					if (m_queue) {
+						LogRecord<T>& queued = m_crashRecord;
+						while (m_queue->tryPop(queued)) {
+							m_queuedBytes.fetch_sub(recordBytes(queued), std::memory_order_relaxed);
+							writeRecord(queued, counters);
+						}
+					}
+					captureRecord(m_record, t_site, LogPriority::Fatal, m_binarySinks != 0, std::forward<Args>(args)...);
+					writeRecord(m_record, counters);
+					flushOutput();
+					return;
+				}
+
+				thread_local LogRecord<T> record;
+				thread_local std::basic_string<T> message;
+				thread_local std::basic_string<T> text;
+				thread_local std::string utf8;
+				captureRecord(record, t_site, LogPriority::Fatal, false, std::forward<Args>(args)...);
+				message.clear();
+				appendMessage(message, record);
+				text.clear();
+				std::shared_ptr<const FormatPattern<T>> pattern = std::atomic_load(&m_directPattern);
+				if (pattern && pattern->layout == formatPattern::TEXT)
+					Formatter<T>::appendRecord(text, *pattern, message, record.time, siteLine(record), siteFile(record), siteFunction(record));
+				else
+					text = message;
+				text += '\n';
+				utf8.clear();
+				appendChars(utf8, text.data(), text.size());
+				writeDirect(LogPriority::Fatal, utf8.data(), utf8.size());
+			}
+
+			/*
+			* Write a queued record as a "LEVEL: message" line from the signal handler
+			* the line is built in m_crashText without locks or the heap
+			* @param record: LogRecord<T>
+			*/
+			void writeCrashLine(const LogRecord<T>& record) noexcept {
+
+				// one byte is kept for the new line
+				FixedText line{ m_crashText, sizeof(m_crashText) - 1, 0 };
+				const char* level = priorityToString(record.level);
+				appendChars(line, level, std::char_traits<char>::length(level));
+				appendChars(line, " ", 1);
+				if (record.argFormat != nullptr)
+					record.argFormat->decodeText(record.args.data, line);
+				else
+					appendChars(line, record.message.data(), record.message.size());
+				line.data[line.size++] = '\n';
+				writeDirect(record.level, line.data, line.size);
+			}
+
+			/*
+			* Pass a UTF-8 line to Sink::writeDirect() of every sink which accepts the level
+			* reads the sinks published by updateSinks(), m_mutex does not have to be held
+			*/
+			void writeDirect(LogPriority messageLevel, const char* t_utf8, size_t t_length) noexcept {
+				const size_t count = m_directCount.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; i++) {
+					Sink<T>* sink = m_directSinks[i].load(std::memory_order_acquire);
+					if (sink != nullptr && sink->accepts(messageLevel))
+						sink->writeDirect(t_utf8, t_length);
+				}
+			}
+
+			/*
+			* Wait a bounded time for the lock, sleeping between the attempts
+			* @param t_lock: unique_lock of m_mutex which does not own it yet
+			* @param t_timeout: maximum wait
+			* @return: true if the lock is owned
+			*/
+			static bool tryLockFor(std::unique_lock<std::mutex>& t_lock, std::chrono::milliseconds t_timeout) noexcept {
+				for (long long waited = 0; ; waited++) {
+					if (t_lock.try_lock())
+						return true;
+					if (waited >= t_timeout.count())
+						return false;
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+
+			/*
+			* Keep a removed sink alive while Fatal records or the crash handler
+			* may still reach it through the published sinks, called with m_mutex held
+			*/
+			void retireSink(const std::shared_ptr<Sink<T>>& t_sink) {
+				if (m_fatalDirect.load(std::memory_order_relaxed) || crash::installed().load(std::memory_order_relaxed))
+					m_retiredSinks.push_back(t_sink);
+			}
+
+			/*
+			* Pass a record to every sink which accepts its level
+			* the record is formatted once for every distinct pattern
+			* @param record: LogRecord<T>
+			* @param counters: block of the calling thread which times formatting and writes, may be nullptr
+			*/
+			void writeRecord(const LogRecord<T>& record, MetricsCounters::Block* counters = nullptr) {
+
+				selectDefaultSink(false);
+				bool hasMessage = false;
+				auto start = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+				for (size_t i = 0; i < m_sinks.size(); i++) {
+					Sink<T>& sink = *m_sinks[i];
+					m_formattedPattern[i] = nullptr;
+					if (!sink.accepts(record.level))
+						continue;
+					if (!sink.textOutput()) {
+						m_formatted[i].clear();
+						sink.write(m_formatted[i], record);
+						if (counters != nullptr)
+							start = countTime(counters->writeNs, start);
+						continue;
+					}
+
+					const FormatPattern<T>* pattern = sink.pattern() != nullptr ? sink.pattern() : &m_pattern;
+					size_t shared = formattedWith(*pattern, i);
+					if (shared == i) {
+						if (!hasMessage) {
+							messageOf(record);
+							hasMessage = true;
+						}
+						m_formatted[i].clear();
+						if (pattern->layout == formatPattern::TEXT)
+							Formatter<T>::appendRecord(m_formatted[i], *pattern, m_message, record.time,
+								siteLine(record), siteFile(record), siteFunction(record));
+						else
+							Formatter<T>::appendStructured(m_formatted[i], *pattern, levelName(record.level), m_message.data() + m_messageOffset,
+								m_message.size() - m_messageOffset, record.fields, record.time, siteLine(record), siteFile(record), siteFunction(record));
+						m_formatted[i] += '\n';
+						m_formattedPattern[i] = pattern;
+						if (counters != nullptr)
+							start = countTime(counters->formatNs, start);
+					}
+					sink.write(m_formatted[shared], record);
+					if (counters != nullptr)
+						start = countTime(counters->writeNs, start);
+				}
+
+				if (m_metricsInterval.count() != 0 && record.time >= m_nextMetricsDump)
+					dumpMetrics(record.time);
+				if (!m_flushScheduled)
+					scheduleFlush();
+			}
+
+			/*
+			* Ask the flush timer to call flushExpired() when the oldest buffered record
+			* of a sink is due, called with m_mutex held after a record was written
+			*/
+			void scheduleFlush() {
+
+				auto due = std::chrono::steady_clock::time_point::max();
+				for (const auto& sink : m_sinks) {
+					if (sink->flushDue() < due)
+						due = sink->flushDue();
+				}
+				if (due == std::chrono::steady_clock::time_point::max())
+					return;
+				if (!m_flushTimer)
+					m_flushTimer = FlushTimer::shared();
+				m_flushTimer->schedule(this, due);
+				m_flushScheduled = true;
+			}
+
+			/*
+			* Called by the flush timer, see scheduleFlush()
+			* Flushes the sinks whose buffered records are older than their flush interval.
+			* @param t_now: steady_clock::time_point
+			* @return: time when the records still buffered are due, time_point::max() if none
+			*/
+			std::chrono::steady_clock::time_point flushExpired(std::chrono::steady_clock::time_point t_now) override {
+
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				auto next = std::chrono::steady_clock::time_point::max();
+				for (const auto& sink : m_sinks) {
+					if (sink->flushDue() <= t_now)
+						sink->flush();
+					if (sink->flushDue() < next)
+						next = sink->flushDue();
+				}
+				m_flushScheduled = next != std::chrono::steady_clock::time_point::max();
+				return next;
+			}
+
+			static unsigned siteLine(const LogRecord<T>& record) noexcept {
+				return record.site != nullptr ? record.site->line : 0;
+			}
+
+			static const char* siteFile(const LogRecord<T>& record) noexcept {
+				return record.site != nullptr ? record.site->file : nullptr;
+			}
+
+			static const char* siteFunction(const LogRecord<T>& record) noexcept {
+				return record.site != nullptr ? record.site->function : nullptr;
+			}
+
+			/*
+			* Add the time since t_start to a counter
+			* @return: current time, the start of the next measured step
+			*/
+			static std::chrono::steady_clock::time_point countTime(std::atomic<uint64_t>& t_counter,
+				std::chrono::steady_clock::time_point t_start) noexcept {
+				auto now = std::chrono::steady_clock::now();
+				metrics::bump(t_counter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - t_start).count()));
+				return now;
+			}
+
+			/*
+			* Take the lock of the logger, time the wait if the lock is held by another thread
+			* @param t_lock: unique_lock of m_mutex which does not own it yet
+			* @param counters: block of the calling thread, nullptr if metrics are disabled
+			*/
+			static void lockTimed(std::unique_lock<std::mutex>& t_lock, MetricsCounters::Block* counters) {
+				if (counters == nullptr || t_lock.try_lock()) {
+					if (!t_lock.owns_lock())
+						t_lock.lock();
+					return;
+				}
+				auto start = std::chrono::steady_clock::now();
+				t_lock.lock();
+				metrics::bump(counters->lockWaitNs, metrics::elapsedNs(start));
+			}
+
+			/*
+			* Fill a snapshot, called with m_mutex held
+			* @param t_metrics: LoggerMetrics
+			*/
+			void collectMetrics(LoggerMetrics& t_metrics) const {
+				m_counters.collect(t_metrics);
+				for (size_t i = 0; i < metrics::levelCount; i++)
+					t_metrics.dropped[i] = m_dropped[i].load(std::memory_order_relaxed);
+				t_metrics.sinks.clear();
+				for (const auto& sink : m_sinks)
+					t_metrics.sinks.push_back(sink->metrics());
+			}
+
+			/*
+			* Write the metrics as a record or to the Prometheus file, called with m_mutex held
+			* @param tp: time of the record which triggered the dump
+			*/
+			void dumpMetrics(const std::chrono::system_clock::time_point& tp) {
+
+				m_nextMetricsDump = tp + m_metricsInterval;
+				LoggerMetrics snapshot;
+				collectMetrics(snapshot);
+
+				if (!m_metricsPath.empty()) {
+					std::string name;
+					appendChars(name, m_name.data(), m_name.size());
+					std::string text;
+					appendPrometheus(text, snapshot, name);
+
+					// replace the file at once, a scraper never reads half of it
+					std::string temp = m_metricsPath + ".tmp";
+					{
+						std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+						file.write(text.data(), static_cast<std::streamsize>(text.size()));
+						if (!file)
+							return;
+					}
+					if (std::rename(temp.c_str(), m_metricsPath.c_str()) != 0) {
+						std::remove(m_metricsPath.c_str());
+						std::rename(temp.c_str(), m_metricsPath.c_str());
+					}
+					return;
+				}
+
+				uint64_t accepted = LoggerMetrics::total(snapshot.accepted);
+				uint64_t filtered = LoggerMetrics::total(snapshot.filtered);
+				uint64_t dropped = LoggerMetrics::total(snapshot.dropped);
+				SinkMetrics sinks;
+				for (const auto& sink : snapshot.sinks) {
+					sinks.bytesWritten += sink.bytesWritten;
+					sinks.rotations += sink.rotations;
+					sinks.writeErrors += sink.writeErrors;
+				}
+
+				m_metricsRecord.level = LogPriority::Info;
+				m_metricsRecord.time = tp;
+				m_metricsRecord.argFormat = nullptr;
+				m_metricsRecord.site = nullptr;
+				m_metricsRecord.args.size = 0;
+				m_metricsRecord.message.clear();
+				m_metricsRecord.fields.clear();
+				Formatter<T>::captureMessage(m_metricsRecord.message, m_metricsRecord.fields, "logger metrics",
+					field("accepted", accepted), field("filtered", filtered), field("dropped", dropped),
+					field("format_ns", snapshot.formatNs), field("write_ns", snapshot.writeNs), field("lock_wait_ns", snapshot.lockWaitNs),
+					field("bytes_written", sinks.bytesWritten), field("rotations", sinks.rotations), field("write_errors", sinks.writeErrors));
+				writeRecord(m_metricsRecord);
+			}
+
+			/*
+			* Find a sink before given index whose text of the current record has the same pattern
+			* @return: index of that sink, t_count if there is none
+			*/
+			size_t formattedWith(const FormatPattern<T>& t_pattern, size_t t_count) const noexcept {
+				for (size_t i = 0; i < t_count; i++) {
+					const FormatPattern<T>* pattern = m_formattedPattern[i];
+					if (pattern != nullptr && (pattern == &t_pattern || (pattern->text == t_pattern.text && pattern->layout == t_pattern.layout
+						&& pattern->precision == t_pattern.precision && pattern->zone == t_pattern.zone)))
+						return i;
+				}
+				return t_count;
+			}
+
+			/*
+			* Flush every sink
+			*/
+			void flushOutput() {
+				for (auto& sink : m_sinks)
+					sink->flush();
+			}
+
+		protected:
+			const std::basic_string<T> m_name;
+			std::mutex m_mutex;
+			FormatPattern<T> m_pattern = Formatter<T>::compilePattern(stringlit(T, "%m %t"));
+			std::basic_string<T> m_logPath;
+			LogOutput m_logOutput = LogOutput::Console;
+			std::vector<std::shared_ptr<Sink<T>>> m_sinks;
+			std::shared_ptr<Sink<T>> m_defaultSink;
+			std::shared_ptr<FileSink<T>> m_fileSink;
+			std::shared_ptr<ConsoleSink<T>> m_consoleSink;
+			bool m_defaultSelected = false;
+			size_t m_binarySinks = 0;
+			std::vector<std::basic_string<T>> m_formatted;
+			std::vector<const FormatPattern<T>*> m_formattedPattern;
+			std::basic_string<T> m_message;
+			size_t m_messageOffset = 0;
+			LogRecord<T> m_record;
+			std::atomic<LogPriority> m_logPriority{ LogPriority::Trace };
+			std::atomic<LogPriority> m_activePriority{ LogPriority::Trace };
+			std::atomic<bool> m_async{ false };
+			std::atomic<bool> m_deferred{ false };
+			std::unique_ptr<AsyncQueue<LogRecord<T>>> m_queue;
+			std::thread m_worker;
+			std::atomic<bool> m_running{ false };
+			std::atomic<bool> m_sleeping{ false };		// writer thread parked in waitForRecords()
+			std::mutex m_wakeMutex;
+			std::condition_variable m_wake;
+			std::atomic<OverflowPolicy> m_overflowPolicy{ OverflowPolicy::Block };
+			std::atomic<LogPriority> m_overflowThreshold{ LogPriority::Error };
+			std::atomic<size_t> m_memoryLimit{ 0 };
+			alignas(64) std::atomic<size_t> m_queuedBytes{ 0 };
+			std::atomic<uint64_t> m_dropped[metrics::levelCount];
+			uint64_t m_reported[metrics::levelCount] = {};
+			std::chrono::milliseconds m_dropReportInterval{ 1000 };
+			LogRecord<T> m_dropRecord;
+			std::atomic<bool> m_metricsEnabled{ false };
+			MetricsCounters m_counters;
+			std::chrono::milliseconds m_metricsInterval{ 0 };
+			std::chrono::system_clock::time_point m_nextMetricsDump;
+			std::string m_metricsPath;
+			LogRecord<T> m_metricsRecord;
+			static constexpr size_t maxDirectSinks = 16;
+			std::atomic<bool> m_fatalDirect{ false };
+			std::atomic<Sink<T>*> m_directSinks[maxDirectSinks];
+			std::atomic<size_t> m_directCount{ 0 };
+			std::shared_ptr<const FormatPattern<T>> m_directPattern;
+			std::vector<std::shared_ptr<Sink<T>>> m_retiredSinks;
+			crash::Node* m_crashNode = nullptr;
+			std::shared_ptr<FlushTimer> m_flushTimer;		// taken when a sink first buffers records
+			bool m_flushScheduled = false;
+			LogRecord<T> m_crashRecord;
+			std::basic_string<T> m_crashMessage;
+			std::string m_crashLine;
+			char m_crashText[4096];		// line of writeCrashLine()
+
+			// slot of the ring of setBacktrace(), written by the record which holds busy
+			struct BacktraceSlot {
+				std::atomic<bool> busy{ false };
+				uint64_t ticket = 0;		// ticket of the record, 0 if empty
+				LogRecord<T> record;
+			};
+
+			struct BacktraceRing {
+				explicit BacktraceRing(size_t t_size) : slots(new BacktraceSlot[t_size]), size(t_size) {}
+				std::unique_ptr<BacktraceSlot[]> slots;
+				size_t size;
+			};
+
+			std::mutex m_backtraceMutex;		// setBacktrace() and dumpBacktrace(), not the capture
+			std::atomic<BacktraceRing*> m_backtrace{ nullptr };
+			std::vector<std::unique_ptr<BacktraceRing>> m_backtraceRings;
+			alignas(64) std::atomic<uint64_t> m_backtraceNext{ 0 };		// last ticket taken by a record
+			std::atomic<uint64_t> m_backtraceDumped{ 0 };		// last ticket written by dumpBacktrace()
+			std::atomic<LogPriority> m_backtraceTrigger{ LogPriority::Quiet };
+			std::atomic<LogPriority> m_backtraceLevel{ LogPriority::Quiet };
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,173 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include "NamedLogger.h"
+
+namespace aricanli {
+	namespace general {
+
+		namespace ratelimit {
+			/*
+			* Monotonic time in nanoseconds, on Linux from the coarse clock
+			* which is read without a system call or the TSC, a few ms resolution is enough here
+			*/
+			inline int64_t nowNs() noexcept {
+#if defined CLOCK_MONOTONIC_COARSE
+				timespec ts;
+				clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+				return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+				return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+			}
+		} // end of ratelimit namespace
+
+		// Class RateLimiter
+		// Token bucket of one call site, used by the LOG_*_LIMIT_* macros as a static local.
+		// The bucket holds up to one second of messages and refills at the given rate,
+		// the state is a single atomic time so a check is one clock read and one compare-and-swap.
+		// Calls rejected while the bucket is empty are counted and reported by the next accepted one.
+		// Example:
+		//	static RateLimiter site;
+		//	if (site.acquire(10)) ...
+		class RateLimiter {
+		public:
+			constexpr RateLimiter() noexcept = default;
+			RateLimiter(const RateLimiter&) = delete;
+			RateLimiter& operator=(const RateLimiter&) = delete;
+
+			/*
+			* Take a token from the bucket
+			* @param t_perSecond: messages accepted per second, also the size of a burst
+			* @return: false if the bucket is empty
+			*/
+			bool acquire(uint64_t t_perSecond) noexcept {
+				if (t_perSecond == 0) {
+					m_suppressed.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				const int64_t interval = static_cast<int64_t>(1000000000ULL / t_perSecond);
+				const int64_t burst = interval * static_cast<int64_t>(t_perSecond - 1);
+				const int64_t now = ratelimit::nowNs();
+				int64_t next = m_next.load(std::memory_order_relaxed);
+				for (;;) {
+					// m_next is the time at which the bucket is full again
+					int64_t base = next > now ? next : now;
+					if (base - now > burst) {
+						m_suppressed.fetch_add(1, std::memory_order_relaxed);
+						return false;
+					}
+					if (m_next.compare_exchange_weak(next, base + interval, std::memory_order_relaxed))
+						return true;
+				}
+			}
+
+			/*
+			* Get and reset the number of rejected calls
+			* @return: uint64_t
+			*/
+			uint64_t takeSuppressed() noexcept {
+				if (m_suppressed.load(std::memory_order_relaxed) == 0)
+					return 0;
+				return m_suppressed.exchange(0, std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<int64_t> m_next{ 0 };
+			std::atomic<uint64_t> m_suppressed{ 0 };
+		}; // end of class
+
+		// Class LogSampler
+		// Counter of one call site, used by the LOG_*_EVERY_* macros as a static local.
+		// Accepts the first call and then every N-th one.
+		class LogSampler {
+		public:
+			constexpr LogSampler() noexcept = default;
+			LogSampler(const LogSampler&) = delete;
+			LogSampler& operator=(const LogSampler&) = delete;
+
+			/*
+			* Count a call
+			* @param t_every: N, 0 and 1 accept every call
+			* @return: true for the first call and every N-th one after it
+			*/
+			bool sample(uint64_t t_every) noexcept {
+				uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+				return t_every <= 1 || count % t_every == 0;
+			}
+
+		private:
+			std::atomic<uint64_t> m_count{ 0 };
+		}; // end of class
+
+		// Class RepeatFilter
+		// State of one call site, used by the LOG_*_DEDUP_* macros as a static local.
+		// After a message is written, further calls of the site within the window are
+		// counted as repeats without evaluating their arguments. The first call after the window
+		// writes "last message repeated N times" in front of its own message.
+		// Repeats are only reported when the site is called again.
+		class RepeatFilter {
+		public:
+			constexpr RepeatFilter() noexcept = default;
+			RepeatFilter(const RepeatFilter&) = delete;
+			RepeatFilter& operator=(const RepeatFilter&) = delete;
+
+			/*
+			* Check whether a call opens a new window
+			* @param t_windowMs: length of the window in milliseconds
+			* @return: false if the call is a repeat
+			*/
+			bool pass(uint64_t t_windowMs) noexcept {
+				const int64_t now = ratelimit::nowNs();
+				int64_t end = m_windowEnd.load(std::memory_order_relaxed);
+				if (now >= end && m_windowEnd.compare_exchange_strong(end, now + static_cast<int64_t>(t_windowMs) * 1000000,
+					std::memory_order_relaxed))
+					return true;
+				m_repeated.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			/*
+			* Get and reset the number of repeats
+			* @return: uint64_t
+			*/
+			uint64_t takeRepeated() noexcept {
+				if (m_repeated.load(std::memory_order_relaxed) == 0)
+					return 0;
+				return m_repeated.exchange(0, std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<int64_t> m_windowEnd{ 0 };
+			std::atomic<uint64_t> m_repeated{ 0 };
+		}; // end of class
+
+		/*
+		* Write "N messages suppressed" for a RateLimiter, called before the accepted message
+		* @param t_logger: NamedLogger<T>
+		* @param t_site: LogSite of the call site
+		* @param messageLevel: level of the call site
+		* @param t_count: RateLimiter::takeSuppressed()
+		*/
+		template <typename T>
+		void logSuppressed(NamedLogger<T>& t_logger, const LogSite* t_site, LogPriority messageLevel, uint64_t t_count) {
+			t_logger.logAt(t_site, messageLevel, t_count, stringlit(T, "messages suppressed"));
+		}
+
+		/*
+		* Write "last message repeated N times" for a RepeatFilter, called before the next message
+		* @param t_logger: NamedLogger<T>
+		* @param t_site: LogSite of the call site
+		* @param messageLevel: level of the call site
+		* @param t_count: RepeatFilter::takeRepeated()
+		*/
+		template <typename T>
+		void logRepeated(NamedLogger<T>& t_logger, const LogSite* t_site, LogPriority messageLevel, uint64_t t_count) {
+			t_logger.logAt(t_site, messageLevel, stringlit(T, "last message repeated"), t_count, stringlit(T, "times"));
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
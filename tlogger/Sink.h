@@ -0,0 +1,328 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <cstdio>
+#include <cwchar>
+#include <functional>
+#include "Formatter.h"
+#include "ArgEncoder.h"
+#include "FileWriter.h"
+#include "LogSite.h"
+
+namespace aricanli {
+	namespace general {
+
+		// LogPriority enum class
+		// Possible priority levels :
+		//Quiet , Fatal , Error , Warning , Info , Verbose , Debug , Trace
+		enum class LogPriority : unsigned int {
+			Quiet = 0,
+			Fatal = 8,
+			Error = 16,
+			Warning = 24,
+			Info = 32,
+			Verbose = 40,
+			Debug = 48,
+			Trace = 56
+		};
+
+		/*
+		* Return the name of a level written by the JSON and LOGFMT layouts
+		* @return: nullptr for Quiet and unknown levels
+		*/
+		inline const char* levelName(LogPriority messageLevel) noexcept {
+			switch (messageLevel) {
+			case LogPriority::Fatal:
+				return "fatal";
+			case LogPriority::Error:
+				return "error";
+			case LogPriority::Warning:
+				return "warning";
+			case LogPriority::Info:
+				return "info";
+			case LogPriority::Verbose:
+				return "verbose";
+			case LogPriority::Debug:
+				return "debug";
+			case LogPriority::Trace:
+				return "trace";
+			default:
+				return nullptr;
+			}
+		}
+
+		// Struct LogRecord<T>
+		// Message captured by log(), passed to every sink which accepts its level.
+		// In async mode it is formatted and written later by the writer thread of the logger.
+		// With deferred formatting the arguments are kept encoded in args and argFormat
+		// reads them back, otherwise message holds the text without the level prefix
+		// and fields the positions of the named arguments in it.
+		template <typename T>
+		struct LogRecord {
+			LogPriority level = LogPriority::Quiet;
+			std::chrono::system_clock::time_point time;
+			std::basic_string<T> message;
+			std::vector<FieldSpan> fields;
+			const ArgFormat<T>* argFormat = nullptr;
+			ArgBuffer args;
+			const LogSite* site = nullptr;	// set by the LOG_* macros
+		};
+
+		// Struct SinkMetrics
+		// Counters of a sink, read with Sink::metrics()
+		struct SinkMetrics {
+			uint64_t bytesWritten = 0;
+			uint64_t rotations = 0;
+			uint64_t writeErrors = 0;
+		};
+
+		// Stream wrapper class for console in char and wchar_t types
+		template <typename T>
+		class StreamWrapper {
+		public:
+			static std::basic_ostream<T>& tout;
+		};
+
+		template<>
+		inline std::ostream& StreamWrapper<char>::tout = std::cout;
+
+		template<>
+		inline std::wostream& StreamWrapper<wchar_t>::tout = std::wcout;
+
+		// Class Sink<T>
+		// Destination of the records of a logger with its own level threshold and pattern.
+		// The logger calls write() under its lock, a sink does not synchronize itself.
+		// Sinks without a pattern use the one of Logger::setFormatter(), the logger formats
+		// a record once for every distinct pattern and passes the same text to the sinks sharing it.
+		// Example:
+		// class VectorSink : public Sink<char> {
+		// public:
+		//	void write(const std::string& t_formatted, const LogRecord<char>&) override { lines.push_back(t_formatted); }
+		//	std::vector<std::string> lines;
+		// };
+		template <typename T>
+		class Sink {
+		public:
+			Sink() noexcept = default;
+			Sink(const Sink&) = delete;
+			Sink& operator=(const Sink&) = delete;
+			virtual ~Sink() noexcept = default;
+
+			/*
+			* Set the most verbose level written by this sink, default is Trace
+			* @param t_level: enum class LogPriority
+			*/
+			void setLevel(LogPriority t_level) {
+				m_level.store(t_level, std::memory_order_relaxed);
+				if (m_levelChanged)
+					m_levelChanged();
+			}
+
+			LogPriority level() const noexcept {
+				return m_level.load(std::memory_order_relaxed);
+			}
+
+			bool accepts(LogPriority t_level) const noexcept {
+				return t_level <= level();
+			}
+
+			/*
+			* Set a pattern of this sink, the pattern of the logger is used if it is not set
+			* set it before the sink is added to a logger
+			* @param t_fmt: basic_string<T> in the syntax of Formatter
+			* @param t_layout: formatPattern, JSON or LOGFMT write one structured record per line
+			*/
+			void setFormatter(const std::basic_string<T>& t_fmt, formatPattern t_layout = formatPattern::TEXT) {
+				Formatter<T>::recompile(m_pattern, t_fmt, t_layout);
+				m_hasPattern = true;
+			}
+
+			/*
+			* Called by the logger the sink is added to, %t of the pattern of the sink
+			* is written in the precision and time zone of the logger
+			* @param t_precision: TimePrecision
+			* @param t_zone: TimeZone
+			*/
+			void useTimestamp(TimePrecision t_precision, TimeZone t_zone) noexcept {
+				m_pattern.precision = t_precision;
+				m_pattern.zone = t_zone;
+			}
+
+			/*
+			* @return: pattern of the sink, nullptr if it uses the pattern of the logger
+			*/
+			const FormatPattern<T>* pattern() const noexcept {
+				return m_hasPattern ? &m_pattern : nullptr;
+			}
+
+			/*
+			* Sinks which write the records themselves, like a binary file,
+			* return false and get an empty text in write()
+			*/
+			virtual bool textOutput() const noexcept {
+				return true;
+			}
+
+			/*
+			* Write one record
+			* @param t_formatted: record formatted with the pattern of the sink followed by a new line
+			* @param record: LogRecord<T>
+			*/
+			virtual void write(const std::basic_string<T>& t_formatted, const LogRecord<T>& record) = 0;
+
+			/*
+			* Write buffered records to the destination
+			*/
+			virtual void flush() { }
+
+			/*
+			* Write a UTF-8 line straight to the destination with async-signal-safe calls,
+			* around the buffers of the sink. The logger calls it without its lock for Fatal
+			* records when the lock is held by another thread, and from the crash handler.
+			* @param t_utf8: formatted line followed by a new line
+			* @param t_length: number of bytes
+			* @return: false if the sink can not write directly
+			*/
+			virtual bool writeDirect(const char* t_utf8, size_t t_length) noexcept {
+				(void)t_utf8;
+				(void)t_length;
+				return false;
+			}
+
+			/*
+			* Write buffered records from the crash handler, other threads may still be running
+			* and the sink can not rely on locks or the heap
+			*/
+			virtual void emergencyFlush() noexcept { }
+
+			/*
+			* Called by the logger when the sink is added, a level change has to reach the logger
+			* which skips the records no sink accepts
+			*/
+			void onLevelChange(std::function<void()> t_callback) {
+				m_levelChanged = std::move(t_callback);
+			}
+
+			/*
+			* Get the bytes written, the file rotations and the failed writes of the sink
+			* can be called from any thread
+			* @return: SinkMetrics
+			*/
+			SinkMetrics metrics() const noexcept {
+				SinkMetrics result;
+				result.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+				result.rotations = m_rotations.load(std::memory_order_relaxed);
+				result.writeErrors = m_writeErrors.load(std::memory_order_relaxed);
+				return result;
+			}
+
+			/*
+			* Time when the oldest buffered record has to be written by flush(), the logger
+			* schedules its flush timer with it. Sinks which buffer records set m_flushDue in write().
+			* @return: steady_clock::time_point, time_point::max() if nothing is buffered
+			*/
+			std::chrono::steady_clock::time_point flushDue() const noexcept {
+				return m_flushDue;
+			}
+
+		protected:
+			/*
+			* Update the counters of metrics(), derived sinks call them from write()
+			*/
+			void countWritten(uint64_t t_bytes) noexcept {
+				m_bytesWritten.store(m_bytesWritten.load(std::memory_order_relaxed) + t_bytes, std::memory_order_relaxed);
+			}
+
+			void countRotation() noexcept {
+				m_rotations.store(m_rotations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+
+			void countWriteErrors(uint64_t t_errors) noexcept {
+				m_writeErrors.store(m_writeErrors.load(std::memory_order_relaxed) + t_errors, std::memory_order_relaxed);
+			}
+
+		protected:
+			std::atomic<LogPriority> m_level{ LogPriority::Trace };
+			FormatPattern<T> m_pattern;
+			bool m_hasPattern = false;
+			std::function<void()> m_levelChanged;
+			std::atomic<uint64_t> m_bytesWritten{ 0 };
+			std::atomic<uint64_t> m_rotations{ 0 };
+			std::atomic<uint64_t> m_writeErrors{ 0 };
+			std::chrono::steady_clock::time_point m_flushDue = std::chrono::steady_clock::time_point::max();
+		}; // end of class
+
+		// Class ConsoleSink<T>
+		// Write records to std::cout, wchar_t records are encoded to UTF-8 instead of
+		// going through std::wcout and the conversion of the global locale.
+		// A stdout which is already wide oriented takes no bytes on glibc, the records
+		// of such programs keep going through std::wcout.
+		// Example:
+		// auto console = std::make_shared<ConsoleSink<char>>();
+		// console->setLevel(LogPriority::Warning);
+		// Logger<char>::addSink(console);
+		template <typename T>
+		class ConsoleSink : public Sink<T> {
+		public:
+			void write(const std::basic_string<T>& t_formatted, const LogRecord<T>&) override {
+				size_t written = writeText(t_formatted);
+				if (m_wide ? StreamWrapper<wchar_t>::tout.fail() : StreamWrapper<char>::tout.fail())
+					this->countWriteErrors(1);
+				else
+					this->countWritten(written);
+			}
+
+			void flush() override {
+				if (m_wide)
+					StreamWrapper<wchar_t>::tout.flush();
+				else
+					StreamWrapper<char>::tout.flush();
+			}
+
+			/*
+			* Write to the descriptor of the standard output, the text buffered
+			* by the stream is not written
+			*/
+			bool writeDirect(const char* t_utf8, size_t t_length) noexcept override {
+				return writeDescriptor(1, t_utf8, t_length);
+			}
+
+		protected:
+			/*
+			* @return: number of bytes
+			*/
+			size_t writeText(const std::string& t_formatted) {
+				StreamWrapper<char>::tout.write(t_formatted.data(), static_cast<std::streamsize>(t_formatted.length()));
+				return t_formatted.length();
+			}
+
+			size_t writeText(const std::wstring& t_formatted) {
+				if (m_orientation == 0) {
+#if defined __GNUC__
+					// decided by the first write to stdout, it does not change afterwards
+					m_orientation = fwide(stdout, 0);
+					m_wide = m_orientation > 0;
+#endif
+				}
+				if (m_wide) {
+					StreamWrapper<wchar_t>::tout.write(t_formatted.data(), static_cast<std::streamsize>(t_formatted.length()));
+					return t_formatted.length();
+				}
+				m_utf8.clear();
+				appendUtf8(m_utf8, t_formatted.data(), t_formatted.length());
+				StreamWrapper<char>::tout.write(m_utf8.data(), static_cast<std::streamsize>(m_utf8.length()));
+				return m_utf8.length();
+			}
+
+		protected:
+			std::string m_utf8;
+			int m_orientation = 0;	// fwide() of stdout, 0 until it is oriented
+			bool m_wide = false;	// stdout is wide oriented, write through std::wcout
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
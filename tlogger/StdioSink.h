@@ -0,0 +1,212 @@
+#pragma once
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include "Sink.h"
+#include "FileWriter.h"
+#if defined _MSC_VER
+	#include <io.h>
+#elif defined __GNUC__
+	#include <unistd.h>
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		// StdStream enum class
+		// Descriptor written by StdioSink
+		enum class StdStream {
+			Out,	// fd 1
+			Err		// fd 2
+		};
+
+		// ColorMode enum class
+		// Never : plain text
+		// Auto : colors on a terminal unless NO_COLOR is set or TERM is dumb
+		// Always : colors also in pipes and files
+		enum class ColorMode {
+			Never,
+			Auto,
+			Always
+		};
+
+		// Class StdioSink<T>
+		// Console sink which writes UTF-8 bytes straight to fd 1 or fd 2 without
+		// std::cout, its stdio synchronization and locale conversion.
+		// On a terminal every record is written at once like a line buffered stream,
+		// in a pipe or a file the records are collected and written in blocks
+		// when the buffer is full, older than the flush interval or flush() is called.
+		// The flush timer of the logger writes the records of an idle buffer.
+		// Text written through std::cout at the same time is not ordered with it.
+		// Example:
+		// auto console = std::make_shared<StdioSink<char>>(StdStream::Out, ColorMode::Auto);
+		// Logger<char>::setSinks({ console });
+		template <typename T>
+		class StdioSink : public Sink<T> {
+		public:
+			/*
+			* @param t_stream: StdStream::Out or StdStream::Err
+			* @param t_colors: ColorMode, colors by level of the records
+			*/
+			explicit StdioSink(StdStream t_stream = StdStream::Out, ColorMode t_colors = ColorMode::Never) {
+				m_fd = t_stream == StdStream::Err ? 2 : 1;
+				m_terminal = isTerminal(m_fd);
+				m_writer.attach(m_fd);
+				if (m_terminal)
+					m_writer.setFlushPolicy(FlushPolicy::EveryRecord, 0, std::chrono::milliseconds(0));
+				setColorMode(t_colors);
+			}
+
+			~StdioSink() noexcept override {
+				m_writer.flush();
+			}
+
+			/*
+			* Set color mode, the colors are escape sequences of ANSI terminals
+			* @param t_colors: ColorMode
+			*/
+			void setColorMode(ColorMode t_colors) {
+				m_colors = t_colors == ColorMode::Always || (t_colors == ColorMode::Auto && m_terminal && colorTerminal());
+			}
+
+			bool colors() const noexcept {
+				return m_colors;
+			}
+
+			/*
+			* Set buffer size and maximum age of buffered records, used when the output is not a terminal
+			* @param t_policy: FlushPolicy
+			* @param t_bufferSize: bytes collected before a write
+			* @param t_interval: maximum time a record waits in the buffer
+			*/
+			void setFlushPolicy(FlushPolicy t_policy, size_t t_bufferSize, std::chrono::milliseconds t_interval) {
+				if (!m_terminal)
+					m_writer.setFlushPolicy(t_policy, t_bufferSize, t_interval);
+			}
+
+			/*
+			* @return: true if the descriptor is a terminal
+			*/
+			bool terminal() const noexcept {
+				return m_terminal;
+			}
+
+			void write(const std::basic_string<T>& t_formatted, const LogRecord<T>& record) override {
+
+				const char* data = nullptr;
+				size_t length = 0;
+				if (!m_colors && sizeof(T) == 1) {
+					data = reinterpret_cast<const char*>(t_formatted.data());
+					length = t_formatted.length();
+				}
+				else {
+					m_line.clear();
+					encode(t_formatted, record.level);
+					data = m_line.data();
+					length = m_line.length();
+				}
+				m_writer.write(data, length, m_terminal ? std::chrono::steady_clock::time_point() : coarseNow());
+				this->m_flushDue = m_writer.flushDue();
+				if (m_writer.errors() != m_errors) {
+					this->countWriteErrors(m_writer.errors() - m_errors);
+					m_errors = m_writer.errors();
+				}
+				else {
+					this->countWritten(length);
+				}
+			}
+
+			void flush() override {
+				m_writer.flush();
+				this->m_flushDue = m_writer.flushDue();
+			}
+
+			bool writeDirect(const char* t_utf8, size_t t_length) noexcept override {
+				return writeDescriptor(m_fd, t_utf8, t_length);
+			}
+
+			void emergencyFlush() noexcept override {
+				m_writer.emergencyFlush();
+			}
+
+		protected:
+			/*
+			* Copy the record into m_line as UTF-8, between the color of its level and
+			* a reset in front of the trailing new line
+			*/
+			void encode(const std::basic_string<T>& t_formatted, LogPriority t_level) {
+
+				size_t length = t_formatted.length();
+				bool newline = length != 0 && t_formatted[length - 1] == '\n';
+				if (m_colors) {
+					m_line += levelColor(t_level);
+					if (newline)
+						length--;
+				}
+				appendText(t_formatted.data(), length);
+				if (m_colors) {
+					m_line += "\x1b[0m";
+					if (newline)
+						m_line += '\n';
+				}
+			}
+
+			void appendText(const char* t_text, size_t t_length) {
+				m_line.append(t_text, t_length);
+			}
+
+			void appendText(const wchar_t* t_text, size_t t_length) {
+				appendUtf8(m_line, t_text, t_length);
+			}
+
+			/*
+			* Escape sequence of a level: Fatal bold red, Error red, Warning yellow,
+			* Info green, Verbose no color, Debug cyan, Trace gray
+			*/
+			static const char* levelColor(LogPriority t_level) noexcept {
+				if (t_level <= LogPriority::Fatal)
+					return "\x1b[1;31m";
+				if (t_level <= LogPriority::Error)
+					return "\x1b[31m";
+				if (t_level <= LogPriority::Warning)
+					return "\x1b[33m";
+				if (t_level <= LogPriority::Info)
+					return "\x1b[32m";
+				if (t_level <= LogPriority::Verbose)
+					return "\x1b[39m";
+				if (t_level <= LogPriority::Debug)
+					return "\x1b[36m";
+				return "\x1b[90m";
+			}
+
+			static bool isTerminal(int t_fd) noexcept {
+#if defined _MSC_VER
+				return _isatty(t_fd) != 0;
+#elif defined __GNUC__
+				return isatty(t_fd) != 0;
+#endif
+			}
+
+			static bool colorTerminal() noexcept {
+#if defined _MSC_VER
+				// the console of Windows needs ENABLE_VIRTUAL_TERMINAL_PROCESSING for escape sequences
+				return false;
+#elif defined __GNUC__
+				if (std::getenv("NO_COLOR") != nullptr)
+					return false;
+				const char* term = std::getenv("TERM");
+				return term == nullptr || std::strcmp(term, "dumb") != 0;
+#endif
+			}
+
+		protected:
+			int m_fd = 1;
+			bool m_terminal = false;
+			bool m_colors = false;
+			PosixFileWriter m_writer;
+			std::string m_line;
+			unsigned long long m_errors = 0;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,465 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define TLOG_UTF8_SSE2 1
+#endif
+
+namespace aricanli {
+	namespace general {
+
+		template <typename C>
+		struct IsCharType : std::integral_constant<bool,
+			std::is_same<C, char>::value || std::is_same<C, wchar_t>::value> {};
+
+		// arithmetic types which are written as characters or as 0/1 instead of numbers
+		template <typename A>
+		struct IsCharLike : std::integral_constant<bool,
+			std::is_same<A, bool>::value || std::is_same<A, char>::value || std::is_same<A, signed char>::value ||
+			std::is_same<A, unsigned char>::value || std::is_same<A, wchar_t>::value> {};
+
+		namespace textconvert {
+			// two decimal digits of 0 ... 99
+			static const char digitPairs[] =
+				"0001020304050607080910111213141516171819"
+				"2021222324252627282930313233343536373839"
+				"4041424344454647484950515253545556575859"
+				"6061626364656667686970717273747576777879"
+				"8081828384858687888990919293949596979899";
+
+			/*
+			* Copy the leading ASCII characters of a wide string as bytes
+			* @param dst: room for length bytes
+			* @return: number of characters copied
+			*/
+			inline size_t copyAscii(char* dst, const wchar_t* src, size_t length) noexcept {
+				size_t i = 0;
+#if defined TLOG_UTF8_SSE2
+				// 16 characters per step, the check of the upper bits also stops at negative values
+				const __m128i zero = _mm_setzero_si128();
+				for (; i + 16 <= length; i += 16) {
+					const __m128i* in = reinterpret_cast<const __m128i*>(src + i);
+					__m128i packed;
+					if (sizeof(wchar_t) == 4) {
+						__m128i a = _mm_loadu_si128(in);
+						__m128i b = _mm_loadu_si128(in + 1);
+						__m128i c = _mm_loadu_si128(in + 2);
+						__m128i d = _mm_loadu_si128(in + 3);
+						__m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(~0x7F));
+						if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+							break;
+						packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+					}
+					else {
+						__m128i a = _mm_loadu_si128(in);
+						__m128i b = _mm_loadu_si128(in + 1);
+						__m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(~0x7F));
+						if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+							break;
+						packed = _mm_packus_epi16(a, b);
+					}
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+				}
+#endif
+				for (; i < length && static_cast<uint32_t>(src[i]) < 0x80; i++)
+					dst[i] = static_cast<char>(src[i]);
+				return i;
+			}
+
+			/*
+			* Copy the leading ASCII bytes of a string as wide characters
+			* @param dst: room for length characters
+			* @return: number of bytes copied
+			*/
+			inline size_t widenAscii(wchar_t* dst, const char* src, size_t length) noexcept {
+				size_t i = 0;
+#if defined TLOG_UTF8_SSE2
+				const __m128i zero = _mm_setzero_si128();
+				for (; i + 16 <= length; i += 16) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					if (_mm_movemask_epi8(v) != 0)
+						break;
+					__m128i low = _mm_unpacklo_epi8(v, zero);
+					__m128i high = _mm_unpackhi_epi8(v, zero);
+					__m128i* out = reinterpret_cast<__m128i*>(dst + i);
+					if (sizeof(wchar_t) == 4) {
+						_mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+						_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+						_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+						_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+					}
+					else {
+						_mm_storeu_si128(out, low);
+						_mm_storeu_si128(out + 1, high);
+					}
+				}
+#endif
+				for (; i < length && static_cast<unsigned char>(src[i]) < 0x80; i++)
+					dst[i] = static_cast<wchar_t>(src[i]);
+				return i;
+			}
+
+			/*
+			* Encode wide characters to UTF-8, invalid code points and unpaired surrogates become U+FFFD
+			* a surrogate pair must not be split at the end of the input
+			* @param dst: room for 4 bytes per character
+			* @return: number of bytes written
+			*/
+			inline size_t encodeUtf8(char* dst, const wchar_t* src, size_t length) noexcept {
+				char* out = dst;
+				size_t i = 0;
+				while (i < length) {
+					uint32_t cp = static_cast<uint32_t>(src[i]);
+					if (cp < 0x80) {
+						size_t ascii = copyAscii(out, src + i, length - i);
+						out += ascii;
+						i += ascii;
+						continue;
+					}
+					i++;
+					if (cp >= 0xD800 && cp < 0xE000) {
+						uint32_t low = i < length ? static_cast<uint32_t>(src[i]) : 0;
+						if (sizeof(wchar_t) == 2 && cp < 0xDC00 && low >= 0xDC00 && low < 0xE000) {
+							cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+							i++;
+						}
+						else {
+							cp = 0xFFFD;
+						}
+					}
+					else if (cp > 0x10FFFF) {
+						cp = 0xFFFD;
+					}
+
+					if (cp < 0x800) {
+						out[0] = static_cast<char>(0xC0 | (cp >> 6));
+						out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+						out += 2;
+					}
+					else if (cp < 0x10000) {
+						out[0] = static_cast<char>(0xE0 | (cp >> 12));
+						out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+						out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+						out += 3;
+					}
+					else {
+						out[0] = static_cast<char>(0xF0 | (cp >> 18));
+						out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+						out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+						out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+						out += 4;
+					}
+				}
+				return static_cast<size_t>(out - dst);
+			}
+
+			/*
+			* Decode one UTF-8 sequence of 2 to 4 bytes, overlong forms, surrogates
+			* and values above U+10FFFF are rejected
+			* @return: length of the sequence, 0 if it is invalid
+			*/
+			inline size_t decodeUtf8(const unsigned char* src, size_t length, uint32_t& cp) noexcept {
+				unsigned char lead = src[0];
+				size_t size = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+				if (size == 0 || size > length)
+					return 0;
+				cp = lead & (0x7F >> size);
+				for (size_t i = 1; i < size; i++) {
+					if ((src[i] & 0xC0) != 0x80)
+						return 0;
+					cp = (cp << 6) | (src[i] & 0x3F);
+				}
+				const uint32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+				if (cp < minimum[size] || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000))
+					return 0;
+				return size;
+			}
+		}
+
+		/*
+		* Append UTF-8 encoding of the characters to given byte string
+		* wchar_t is read as UTF-16 on Windows and UTF-32 elsewhere,
+		* runs of ASCII characters are copied 16 at a time
+		*/
+		inline void appendUtf8(std::string& out, const char* str, size_t length) {
+			out.append(str, length);
+		}
+
+		inline void appendUtf8(std::string& out, const wchar_t* str, size_t length) {
+			char buffer[512];
+			const size_t block = sizeof(buffer) / 4;
+			while (length != 0) {
+				size_t count = length < block ? length : block;
+				// keep a surrogate pair in one block
+				uint32_t last = static_cast<uint32_t>(str[count - 1]);
+				if (sizeof(wchar_t) == 2 && count < length && last >= 0xD800 && last < 0xDC00)
+					count--;
+				out.append(buffer, textconvert::encodeUtf8(buffer, str, count));
+				str += count;
+				length -= count;
+			}
+		}
+
+		/*
+		* Append characters to a string of the same or the other character type
+		* narrow characters are decoded from UTF-8, a byte which is not part of a valid
+		* sequence is widened as it is (Latin-1), wide characters are encoded to UTF-8
+		*/
+		template <typename T>
+		inline void appendChars(std::basic_string<T>& out, const T* str, size_t length) {
+			out.append(str, length);
+		}
+
+		inline void appendChars(std::wstring& out, const char* str, size_t length) {
+			size_t start = out.size();
+			out.resize(start + length);
+			wchar_t* dst = &out[start];
+			const unsigned char* src = reinterpret_cast<const unsigned char*>(str);
+			size_t i = 0;
+			while (i < length) {
+				if (src[i] < 0x80) {
+					size_t ascii = textconvert::widenAscii(dst, str + i, length - i);
+					dst += ascii;
+					i += ascii;
+					continue;
+				}
+				uint32_t cp = 0;
+				size_t size = textconvert::decodeUtf8(src + i, length - i, cp);
+				if (size == 0) {
+					*dst++ = static_cast<wchar_t>(src[i++]);
+					continue;
+				}
+				i += size;
+				if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+					// 4 bytes give 2 units, the string is long enough
+					*dst++ = static_cast<wchar_t>(0xD800 + ((cp - 0x10000) >> 10));
+					*dst++ = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+				}
+				else {
+					*dst++ = static_cast<wchar_t>(cp);
+				}
+			}
+			out.resize(static_cast<size_t>(dst - out.data()));
+		}
+
+		inline void appendChars(std::string& out, const wchar_t* str, size_t length) {
+			appendUtf8(out, str, length);
+		}
+
+		// Struct FixedText
+		// UTF-8 text in a buffer of the caller, text beyond its capacity is cut off at a
+		// character boundary. Nothing is allocated, so it can be filled in a signal handler.
+		struct FixedText {
+			char* data;
+			size_t capacity;
+			size_t size;
+		};
+
+		inline void appendChars(FixedText& out, const char* str, size_t length) noexcept {
+			size_t room = out.capacity - out.size;
+			if (length > room) {
+				length = room;
+				while (length != 0 && (static_cast<unsigned char>(str[length]) & 0xC0) == 0x80)
+					length--;
+			}
+			std::memcpy(out.data + out.size, str, length);
+			out.size += length;
+		}
+
+		inline void appendChars(FixedText& out, const wchar_t* str, size_t length) noexcept {
+			char buffer[512];
+			const size_t block = sizeof(buffer) / 4;
+			while (length != 0 && out.size < out.capacity) {
+				size_t count = length < block ? length : block;
+				uint32_t last = static_cast<uint32_t>(str[count - 1]);
+				if (sizeof(wchar_t) == 2 && count < length && last >= 0xD800 && last < 0xDC00)
+					count--;
+				appendChars(out, buffer, textconvert::encodeUtf8(buffer, str, count));
+				str += count;
+				length -= count;
+			}
+		}
+
+		/*
+		* Length of a string literal known from its array size
+		* trailing null characters of a larger array are not counted
+		*/
+		template <size_t N, typename C>
+		inline size_t literalLength(const C* str) noexcept {
+			size_t length = N;
+			while (length != 0 && str[length - 1] == C())
+				length--;
+			return length;
+		}
+
+		// Struct Literal<C>
+		// String with static storage duration, created with literal()
+		// deferred records and the backtrace keep it by pointer, binary files write it once per file
+		template <typename C>
+		struct Literal {
+			const C* str;
+			size_t length;
+		};
+
+		/*
+		* Mark a string literal, every other character array is copied when it is logged
+		* Example: LOG_INFO_C(literal("connection lost"), id);
+		* @param str: string literal, never a local or member array
+		*/
+		template <typename C, size_t N>
+		inline Literal<C> literal(const C(&str)[N]) noexcept {
+			return Literal<C>{ str, literalLength<N>(str) };
+		}
+
+		/*
+		* Write the decimal digits of value two at a time, backwards from end
+		* @return: first digit
+		*/
+		inline char* formatUnsigned(char* end, unsigned long long value) noexcept {
+			while (value >= 100) {
+				unsigned index = static_cast<unsigned>(value % 100) * 2;
+				value /= 100;
+				*--end = textconvert::digitPairs[index + 1];
+				*--end = textconvert::digitPairs[index];
+			}
+			if (value >= 10) {
+				unsigned index = static_cast<unsigned>(value) * 2;
+				*--end = textconvert::digitPairs[index + 1];
+				*--end = textconvert::digitPairs[index];
+			}
+			else {
+				*--end = static_cast<char>('0' + value);
+			}
+			return end;
+		}
+
+		template <typename Out>
+		inline void appendUnsigned(Out& out, unsigned long long value) {
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			char* begin = formatUnsigned(end, value);
+			appendChars(out, begin, static_cast<size_t>(end - begin));
+		}
+
+		template <typename Out>
+		inline void appendSigned(Out& out, long long value) {
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+			char* begin = formatUnsigned(end, magnitude);
+			if (value < 0)
+				*--begin = '-';
+			appendChars(out, begin, static_cast<size_t>(end - begin));
+		}
+
+		/*
+		* Append the shortest text which reads back to the same value
+		* falls back to printf with max_digits10 where std::to_chars has no floating point support
+		*/
+		template <typename Out, typename F>
+		inline void appendFloating(Out& out, F value) {
+			char buffer[64];
+#if defined __cpp_lib_to_chars
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			appendChars(out, buffer, static_cast<size_t>(result.ptr - buffer));
+#else
+			int length = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<F>::max_digits10, static_cast<double>(value));
+			appendChars(out, buffer, length > 0 ? static_cast<size_t>(length) : 0);
+#endif
+		}
+
+		/*
+		* Append an arithmetic value
+		* bool is written as 1 or 0 and character types as characters, like operator<< does
+		*/
+		template <typename T>
+		inline void appendValue(std::basic_string<T>& out, bool value) {
+			out += static_cast<T>(value ? '1' : '0');
+		}
+
+		template <typename T>
+		inline void appendValue(std::basic_string<T>& out, char value) {
+			out += static_cast<T>(static_cast<unsigned char>(value));
+		}
+
+		template <typename T>
+		inline void appendValue(std::basic_string<T>& out, signed char value) {
+			out += static_cast<T>(static_cast<unsigned char>(value));
+		}
+
+		template <typename T>
+		inline void appendValue(std::basic_string<T>& out, unsigned char value) {
+			out += static_cast<T>(value);
+		}
+
+		inline void appendValue(std::wstring& out, wchar_t value) {
+			out += value;
+		}
+
+		inline void appendValue(std::string& out, wchar_t value) {
+			appendUtf8(out, &value, 1);
+		}
+
+		template <typename T, typename A>
+		inline typename std::enable_if<std::is_integral<A>::value && std::is_signed<A>::value && !IsCharLike<A>::value>::type
+			appendValue(std::basic_string<T>& out, A value) {
+			appendSigned(out, static_cast<long long>(value));
+		}
+
+		template <typename T, typename A>
+		inline typename std::enable_if<std::is_integral<A>::value && !std::is_signed<A>::value && !IsCharLike<A>::value>::type
+			appendValue(std::basic_string<T>& out, A value) {
+			appendUnsigned(out, static_cast<unsigned long long>(value));
+		}
+
+		template <typename T, typename A>
+		inline typename std::enable_if<std::is_floating_point<A>::value>::type appendValue(std::basic_string<T>& out, A value) {
+			appendFloating(out, value);
+		}
+
+		/*
+		* Append an arithmetic value to a FixedText, same text as the overloads above
+		*/
+		inline void appendValue(FixedText& out, bool value) noexcept {
+			appendChars(out, value ? "1" : "0", 1);
+		}
+
+		template <typename A>
+		inline typename std::enable_if<IsCharLike<A>::value && sizeof(A) == 1 && !std::is_same<A, bool>::value>::type
+			appendValue(FixedText& out, A value) noexcept {
+			char c = static_cast<char>(value);
+			appendChars(out, &c, 1);
+		}
+
+		inline void appendValue(FixedText& out, wchar_t value) noexcept {
+			appendChars(out, &value, 1);
+		}
+
+		template <typename A>
+		inline typename std::enable_if<std::is_integral<A>::value && std::is_signed<A>::value && !IsCharLike<A>::value>::type
+			appendValue(FixedText& out, A value) noexcept {
+			appendSigned(out, static_cast<long long>(value));
+		}
+
+		template <typename A>
+		inline typename std::enable_if<std::is_integral<A>::value && !std::is_signed<A>::value && !IsCharLike<A>::value>::type
+			appendValue(FixedText& out, A value) noexcept {
+			appendUnsigned(out, static_cast<unsigned long long>(value));
+		}
+
+		template <typename A>
+		inline typename std::enable_if<std::is_floating_point<A>::value>::type appendValue(FixedText& out, A value) noexcept {
+			appendFloating(out, value);
+		}
+
+	} // end of general namespace
+} // end of aricanli namespace
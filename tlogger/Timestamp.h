@@ -0,0 +1,169 @@
+#pragma once
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+
+namespace aricanli {
+	namespace general {
+
+		// TimePrecision enum class
+		// Number of sub-second digits of %t : none , 3 , 6 , 9
+		enum class TimePrecision {
+			Seconds,
+			Milliseconds,
+			Microseconds,
+			Nanoseconds
+		};
+
+		// TimeZone enum class
+		// Local time with +hh:mm offset or UTC with Z suffix
+		enum class TimeZone {
+			Local,
+			Utc
+		};
+
+		// Class TimestampCache<T>
+		// ISO-8601 timestamp text in char or wchar_t
+		// The date and time up to the seconds is rebuilt only when the second changes,
+		// other calls rewrite the sub-second digits in place.
+		// Example:
+		// TimestampCache<char> cache;
+		// size_t length;
+		// const char* ts = cache.get(std::chrono::system_clock::now(), TimePrecision::Milliseconds, TimeZone::Utc, length);
+		// // 2026-10-18T06:49:36.123Z
+		template <typename T>
+		class TimestampCache {
+		public:
+			/*
+			* Get the timestamp text of given time point
+			* @param tp: chrono::system_clock::time_point
+			* @param t_precision: TimePrecision
+			* @param t_zone: TimeZone
+			* @param length: set to the number of characters
+			* @return: const T* valid until the next call
+			*/
+			const T* get(const std::chrono::system_clock::time_point& tp, TimePrecision t_precision, TimeZone t_zone, size_t& length) {
+
+				int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+				int64_t second = ns / 1000000000;
+				int64_t fraction = ns % 1000000000;
+				if (fraction < 0) {
+					fraction += 1000000000;
+					second--;
+				}
+
+				if (second != m_second || t_precision != m_precision || t_zone != m_zone)
+					rebuild(second, t_precision, t_zone);
+
+				// keep the leading digits of the nanoseconds
+				unsigned digits = fractionDigits(t_precision);
+				for (unsigned i = 9; i > digits; i--)
+					fraction /= 10;
+				for (size_t pos = m_fractionPos + digits; pos > m_fractionPos; pos--) {
+					m_text[pos - 1] = static_cast<T>('0' + fraction % 10);
+					fraction /= 10;
+				}
+
+				length = m_length;
+				return m_text;
+			}
+
+		protected:
+			static unsigned fractionDigits(TimePrecision t_precision) noexcept {
+				switch (t_precision) {
+				case TimePrecision::Milliseconds:
+					return 3;
+				case TimePrecision::Microseconds:
+					return 6;
+				case TimePrecision::Nanoseconds:
+					return 9;
+				default:
+					return 0;
+				}
+			}
+
+			/*
+			* Build "YYYY-MM-DDTHH:MM:SS[.fff]" followed by the zone suffix for a new second
+			*/
+			void rebuild(int64_t second, TimePrecision t_precision, TimeZone t_zone) {
+
+				std::time_t t = static_cast<std::time_t>(second);
+				std::tm tm{};
+				long offset = 0;
+				if (t_zone == TimeZone::Utc) {
+#if defined _MSC_VER
+					gmtime_s(&tm, &t);
+#elif defined __GNUC__
+					gmtime_r(&t, &tm);
+#endif
+				}
+				else {
+#if defined _MSC_VER
+					localtime_s(&tm, &t);
+					long tz = 0;
+					_get_timezone(&tz);
+					offset = -tz + (tm.tm_isdst > 0 ? 3600 : 0);
+#elif defined __GNUC__
+					localtime_r(&t, &tm);
+					offset = tm.tm_gmtoff;
+#endif
+				}
+
+				size_t pos = 0;
+				putNumber(pos, tm.tm_year + 1900, 4);
+				m_text[pos++] = '-';
+				putNumber(pos, tm.tm_mon + 1, 2);
+				m_text[pos++] = '-';
+				putNumber(pos, tm.tm_mday, 2);
+				m_text[pos++] = 'T';
+				putNumber(pos, tm.tm_hour, 2);
+				m_text[pos++] = ':';
+				putNumber(pos, tm.tm_min, 2);
+				m_text[pos++] = ':';
+				putNumber(pos, tm.tm_sec, 2);
+
+				unsigned digits = fractionDigits(t_precision);
+				if (digits != 0)
+					m_text[pos++] = '.';
+				m_fractionPos = pos;
+				pos += digits;
+
+				if (t_zone == TimeZone::Utc) {
+					m_text[pos++] = 'Z';
+				}
+				else {
+					m_text[pos++] = offset < 0 ? '-' : '+';
+					if (offset < 0)
+						offset = -offset;
+					putNumber(pos, static_cast<int>(offset / 3600), 2);
+					m_text[pos++] = ':';
+					putNumber(pos, static_cast<int>(offset % 3600 / 60), 2);
+				}
+				m_text[pos] = '\0';
+
+				m_length = pos;
+				m_second = second;
+				m_precision = t_precision;
+				m_zone = t_zone;
+			}
+
+			void putNumber(size_t& pos, int value, int width) noexcept {
+				for (int i = width - 1; i >= 0; i--) {
+					m_text[pos + i] = static_cast<T>('0' + value % 10);
+					value /= 10;
+				}
+				pos += width;
+			}
+
+		protected:
+			T m_text[48] = {};
+			size_t m_length = 0;
+			size_t m_fractionPos = 0;
+			int64_t m_second = INT64_MIN;
+			TimePrecision m_precision = TimePrecision::Milliseconds;
+			TimeZone m_zone = TimeZone::Local;
+		}; // end of class
+
+	} // end of general namespace
+} // end of aricanli namespace
@@ -0,0 +1,329 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include "Formatter.h"
+#include "BinaryLog.h"
+
+using namespace aricanli::general;
+
+// Offline decoder of the files written with FileFormat::Binary
+// prints every record as text with the pattern of Formatter
+// Usage: tlog_decode [-f pattern] [-p s|ms|us|ns] [-utc] file...
+// Example: tlog_decode -f "%t %m" -p us log/log.txt
+
+struct CallSite {
+	uint32_t file = 0;
+	uint32_t line = 0;
+	uint32_t function = 0;
+};
+
+class BinaryLogReader {
+public:
+	explicit BinaryLogReader(std::string t_data) : m_data(std::move(t_data)) { }
+
+	/*
+	* Decode all records and write them to out
+	* @return: false if the file is not a binary log or ends in the middle of an entry
+	*/
+	bool decode(std::ostream& out) {
+
+		while (m_pos < m_data.size()) {
+			char tag = m_data[m_pos];
+			if (tag == binarylog::magic[0]) {
+				if (!readHeader())
+					return false;
+				continue;
+			}
+			if (!m_header)
+				return fail("missing header");
+
+			m_pos++;
+			bool ok = false;
+			switch (tag) {
+			case binarylog::tagString:
+				ok = readString();
+				break;
+			case binarylog::tagSite:
+				ok = readSite();
+				break;
+			case binarylog::tagRecord:
+				ok = readRecord(out);
+				break;
+			default:
+				return fail("unknown entry");
+			}
+			if (!ok)
+				return fail("truncated entry");
+		}
+		return true;
+	}
+
+	const std::string& error() const noexcept {
+		return m_error;
+	}
+
+protected:
+	template <typename V>
+	bool get(V& value) noexcept {
+		if (m_data.size() - m_pos < sizeof(V))
+			return false;
+		std::memcpy(&value, m_data.data() + m_pos, sizeof(V));
+		m_pos += sizeof(V);
+		return true;
+	}
+
+	bool getBytes(std::string& str, uint32_t length) {
+		if (m_data.size() - m_pos < length)
+			return false;
+		str.assign(m_data, m_pos, length);
+		m_pos += length;
+		return true;
+	}
+
+	bool fail(const char* reason) {
+		std::ostringstream oss;
+		oss << reason << " at offset " << m_pos;
+		m_error = oss.str();
+		return false;
+	}
+
+	// every opened file starts with a header, the dictionaries start again after it
+	bool readHeader() {
+		const size_t magicLength = sizeof(binarylog::magic) - 1;
+		if (m_data.compare(m_pos, magicLength, binarylog::magic) != 0 || m_data.size() - m_pos < magicLength + 1)
+			return fail("not a binary log");
+		if (static_cast<unsigned char>(m_data[m_pos + magicLength]) != binarylog::version)
+			return fail("unsupported version");
+		m_pos += magicLength + 1;
+		m_strings.clear();
+		m_sites.clear();
+		m_header = true;
+		return true;
+	}
+
+	bool readString() {
+		uint32_t id, length;
+		std::string str;
+		if (!get(id) || !get(length) || !getBytes(str, length))
+			return false;
+		m_strings[id] = std::move(str);
+		return true;
+	}
+
+	bool readSite() {
+		uint32_t id;
+		CallSite site;
+		if (!get(id) || !get(site.file) || !get(site.line) || !get(site.function))
+			return false;
+		m_sites[id] = site;
+		return true;
+	}
+
+	bool readRecord(std::ostream& out) {
+		unsigned char level;
+		int64_t ns;
+		uint32_t siteId;
+		uint16_t argCount;
+		if (!get(level) || !get(ns) || !get(siteId) || !get(argCount))
+			return false;
+
+		m_message.assign(levelToString(level));
+		m_message += ' ';
+		for (uint16_t i = 0; i < argCount; i++) {
+			if (!readArg())
+				return false;
+			m_message += ' ';
+		}
+
+		CallSite site;
+		auto found = m_sites.find(siteId);
+		if (found != m_sites.end())
+			site = found->second;
+		const std::string* file = stringOf(site.file);
+		const std::string* function = stringOf(site.function);
+
+		std::chrono::system_clock::time_point tp(
+			std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+		out << Formatter<char>::formatRecord(m_message, tp, site.line, file != nullptr ? file->c_str() : nullptr,
+			function != nullptr ? function->c_str() : nullptr) << '\n';
+		return true;
+	}
+
+	// arguments are written in the layout of Formatter::formatMessage()
+	bool readArg() {
+		char tag;
+		if (!get(tag))
+			return false;
+
+		switch (tag) {
+		case binarylog::argInt: {
+			int64_t value;
+			if (!get(value))
+				return false;
+			appendValue(m_message, value);
+			return true;
+		}
+		case binarylog::argUInt: {
+			uint64_t value;
+			if (!get(value))
+				return false;
+			appendValue(m_message, value);
+			return true;
+		}
+		case binarylog::argDouble: {
+			double value;
+			if (!get(value))
+				return false;
+			appendValue(m_message, value);
+			return true;
+		}
+		case binarylog::argFloat: {
+			float value;
+			if (!get(value))
+				return false;
+			appendValue(m_message, value);
+			return true;
+		}
+		case binarylog::argBool: {
+			unsigned char value;
+			if (!get(value))
+				return false;
+			appendValue(m_message, value != 0);
+			return true;
+		}
+		case binarylog::argChar: {
+			uint32_t codePoint;
+			if (!get(codePoint))
+				return false;
+			appendValue(m_message, static_cast<wchar_t>(codePoint));
+			return true;
+		}
+		case binarylog::argStringId: {
+			uint32_t id;
+			if (!get(id))
+				return false;
+			const std::string* str = stringOf(id);
+			if (str != nullptr)
+				m_message += *str;
+			return true;
+		}
+		case binarylog::argString: {
+			uint32_t length;
+			std::string str;
+			if (!get(length) || !getBytes(str, length))
+				return false;
+			m_message += str;
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+
+	const std::string* stringOf(uint32_t id) const {
+		auto found = m_strings.find(id);
+		return found != m_strings.end() ? &found->second : nullptr;
+	}
+
+	static const char* levelToString(unsigned level) noexcept {
+		switch (level) {
+		case 8:
+			return "FATAL:";
+		case 16:
+			return "ERROR:";
+		case 24:
+			return "WARNING:";
+		case 32:
+			return "INFO:";
+		case 40:
+			return "VERBOSE:";
+		case 48:
+			return "DEBUG:";
+		case 56:
+			return "TRACE:";
+		default:
+			return "UNKNOWN:";
+		}
+	}
+
+protected:
+	std::string m_data;
+	size_t m_pos = 0;
+	bool m_header = false;
+	std::string m_error;
+	std::string m_message;
+	std::unordered_map<uint32_t, std::string> m_strings;
+	std::unordered_map<uint32_t, CallSite> m_sites;
+};
+
+static void usage() {
+	std::cerr << "Usage: tlog_decode [-f pattern] [-p s|ms|us|ns] [-utc] file...\n"
+		<< "  -f    pattern of the output, default \"%m %t\"\n"
+		<< "  -p    sub-second precision of %t, default ms\n"
+		<< "  -utc  print %t in UTC instead of local time\n";
+}
+
+int main(int argc, char* argv[]) {
+
+	TimePrecision precision = TimePrecision::Milliseconds;
+	TimeZone zone = TimeZone::Local;
+	int files = 0;
+	int status = 0;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-f" && i + 1 < argc) {
+			Formatter<char>::getFormatter(argv[++i]);
+		}
+		else if (arg == "-p" && i + 1 < argc) {
+			std::string p = argv[++i];
+			if (p == "s")
+				precision = TimePrecision::Seconds;
+			else if (p == "ms")
+				precision = TimePrecision::Milliseconds;
+			else if (p == "us")
+				precision = TimePrecision::Microseconds;
+			else if (p == "ns")
+				precision = TimePrecision::Nanoseconds;
+			else {
+				usage();
+				return 2;
+			}
+		}
+		else if (arg == "-utc") {
+			zone = TimeZone::Utc;
+		}
+		else if (!arg.empty() && arg[0] == '-') {
+			usage();
+			return 2;
+		}
+		else {
+			Formatter<char>::setTimestamp(precision, zone);
+			std::ifstream in(arg, std::ios::binary);
+			if (!in) {
+				std::cerr << "tlog_decode: can not open " << arg << "\n";
+				status = 1;
+				continue;
+			}
+			std::ostringstream content;
+			content << in.rdbuf();
+
+			BinaryLogReader reader(content.str());
+			if (!reader.decode(std::cout)) {
+				std::cerr << "tlog_decode: " << arg << ": " << reader.error() << "\n";
+				status = 1;
+			}
+			files++;
+		}
+	}
+
+	if (files == 0 && status == 0) {
+		usage();
+		return 2;
+	}
+	return status;
+}